@@ -27,25 +27,24 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       aliases.c
- * DESCRIPCIN:   Cdigo fuente de los aliases.
+ * DESCRIPCIÓN:   Código fuente de los aliases.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "aliases.h"
 #include "config.h"
-#include "infolinea.h"
 #include "io.h"
 
 // Estructura para almacenar un alias.
 typedef struct
 {
-  char alias [ 256 ];
-  char valor [ 256 ];
+  char* alias;
+  char* valor;
 } Alias;
 
 // Nodos de la tabla hash.
@@ -64,11 +63,11 @@ struct Aliases_
 
 static inline unsigned int aliases_hash ( const char* str )
 {
-  // Intentaremos generar un hash con una buena dispersin
-  // y evitando el solapamiento al mximo. Un buen desplazamiento
+  // Intentaremos generar un hash con una buena dispersión
+  // y evitando el solapamiento al máximo. Un buen desplazamiento
   // para esto puede ser 7, requiriendo 32 vueltas antes de
-  // que los bits vuelvan a la posicin original al ser primo.
-  // Adems, como en cada vuelta se aaden 8 nuevos bits, el
+  // que los bits vuelvan a la posición original al ser primo.
+  // Además, como en cada vuelta se añaden 8 nuevos bits, el
   // solapamiento es de un solo bit.
   unsigned int result = 0;
   const char* p = str;
@@ -113,6 +112,8 @@ void aliases_eliminar ( Aliases* aliases )
       for ( actual = aliases->nodos[i]; actual != NULL; actual = siguiente )
       {
         siguiente = actual->siguiente;
+        free ( actual->alias.alias );
+        free ( actual->alias.valor );
         free ( actual );
       }
     }
@@ -140,10 +141,17 @@ static NodoHash* aliases_buscar_nodo ( Aliases* aliases, const char* alias )
   return nodo;
 }
 
+const char* aliases_obtener ( Aliases* aliases, const char* alias )
+{
+  NodoHash* nodo = aliases_buscar_nodo ( aliases, alias );
+  return ( nodo != NULL ) ? nodo->alias.valor : NULL;
+}
+
 void aliases_establecer ( Aliases* aliases, const char* alias, const char* valor )
 {
   // Buscamos el nodo, si existe, de este alias.
   NodoHash* nodo = aliases_buscar_nodo ( aliases, alias );
+  char* copia;
 
   // Si no se ha encontrado, creamos uno nuevo.
   if ( nodo == NULL )
@@ -153,7 +161,7 @@ void aliases_establecer ( Aliases* aliases, const char* alias, const char* valor
 
     nodo = (NodoHash *)malloc(sizeof(NodoHash));
     memset ( nodo, 0, sizeof(NodoHash) );
-    strcpy ( nodo->alias.alias, alias );
+    nodo->alias.alias = strdup ( alias );
     if ( aliases->nodos [ pos ] )
     {
       aliases->nodos [ pos ]->anterior = nodo;
@@ -163,8 +171,10 @@ void aliases_establecer ( Aliases* aliases, const char* alias, const char* valor
     aliases->nodos [ pos ] = nodo;
   }
 
-  // Cambiamos el valor.
-  strcpy ( nodo->alias.valor, valor );
+  // Cambiamos el valor, copiándolo antes de liberar el anterior.
+  copia = strdup ( valor );
+  free ( nodo->alias.valor );
+  nodo->alias.valor = copia;
 }
 
 void aliases_eliminar_alias ( Aliases* aliases, const char* alias )
@@ -193,80 +203,144 @@ void aliases_eliminar_alias ( Aliases* aliases, const char* alias )
       }
     }
 
+    free ( nodo->alias.alias );
+    free ( nodo->alias.valor );
     free ( nodo );
   }
 }
 
-char* aliases_procesar_linea ( Aliases* aliases, char* linea, char* nuevaLinea )
+static int insertar_alias ( Tuberia* tuberia, int posicion, Tuberia* valor, Arena* arena )
 {
-  // Procesamos la linea.
-  InfoLinea info;
-  infolinea_procesar ( &info, linea, NULL, -1 );
+  Comando* ultimo = &(valor->comandos [ valor->numComandos - 1 ]);
+  Comando* comando = &(tuberia->comandos[posicion]);
+  int anteriores = valor->numComandos - 1;
+  Palabra* palabras = NULL;
+  Redireccion* redirecciones = NULL;
+  int numPalabras = 0;
+  int numRedirecciones = 0;
+  int i;
+
+  // El último comando del alias toma el lugar del nombre, seguido del resto
+  // de palabras y redirecciones del comando original.
+  for ( i = 0; i < ultimo->numPalabras + comando->numPalabras - 1; ++i )
+  {
+    palabras = (Palabra *)analizador_crecer ( arena, palabras, numPalabras, sizeof(Palabra) );
+    palabras [ numPalabras++ ] = ( i < ultimo->numPalabras ) ? ultimo->palabras[i]
+                                                               : comando->palabras[i - ultimo->numPalabras + 1];
+  }
+  for ( i = 0; i < ultimo->numRedirecciones + comando->numRedirecciones; ++i )
+  {
+    redirecciones = (Redireccion *)analizador_crecer ( arena, redirecciones, numRedirecciones, sizeof(Redireccion) );
+    redirecciones [ numRedirecciones++ ] = ( i < ultimo->numRedirecciones ) ? ultimo->redirecciones[i]
+                                                                              : comando->redirecciones[i - ultimo->numRedirecciones];
+  }
+
+  comando->palabras = palabras;
+  comando->numPalabras = numPalabras;
+  comando->redirecciones = redirecciones;
+  comando->numRedirecciones = numRedirecciones;
+
+  // Si el alias era una pipeline, sus otros comandos van delante.
+  for ( i = 0; i < anteriores; ++i )
+  {
+    tuberia->comandos = (Comando *)analizador_crecer ( arena, tuberia->comandos, tuberia->numComandos, sizeof(Comando) );
+    tuberia->numComandos++;
+  }
+  memmove ( &(tuberia->comandos [ posicion + anteriores ]), &(tuberia->comandos [ posicion ]),
+            sizeof(Comando) * ( tuberia->numComandos - anteriores - posicion ) );
+  memcpy ( &(tuberia->comandos [ posicion ]), valor->comandos, sizeof(Comando) * anteriores );
+
+  return anteriores;
+}
+
+// El alias tiene varias pipelines: como si se sustituyera el texto, la primera
+// continúa a los comandos anteriores al nombre, la última se une al resto de
+// la pipeline original y las demás se intercalan en la lista con sus
+// condiciones. Devuelve el número de comandos del alias en la última.
+static int dividir_tuberia ( ArbolLinea* arbol, int posicion, int comando, ArbolLinea* valor, Arena* arena )
+{
+  Tuberia original = arbol->tuberias[posicion];
+  Tuberia* primera = &(valor->tuberias[0]);
+  Tuberia* ultima = &(valor->tuberias [ valor->numTuberias - 1 ]);
+  Comando* comandos = NULL;
+  int numComandos = 0;
+  int anteriores;
+  int i;
+
+  for ( i = 0; i < comando + primera->numComandos; ++i )
+  {
+    comandos = (Comando *)analizador_crecer ( arena, comandos, numComandos, sizeof(Comando) );
+    comandos [ numComandos++ ] = ( i < comando ) ? original.comandos[i] : primera->comandos[i - comando];
+  }
+  primera->comandos = comandos;
+  primera->numComandos = numComandos;
+  primera->condicion = original.condicion;
+
+  comandos = NULL;
+  numComandos = 0;
+  for ( i = comando; i < original.numComandos; ++i )
+  {
+    comandos = (Comando *)analizador_crecer ( arena, comandos, numComandos, sizeof(Comando) );
+    comandos [ numComandos++ ] = original.comandos[i];
+  }
+  original.comandos = comandos;
+  original.numComandos = numComandos;
+  anteriores = insertar_alias ( &original, 0, ultima, arena );
+  original.condicion = ultima->condicion;
+  *ultima = original;
 
-  // Nos aseguramos de que haya algn programa.
-  if ( info.numProgramas == 0 )
+  for ( i = 1; i < valor->numTuberias; ++i )
   {
-    return linea;
+    arbol->tuberias = (Tuberia *)analizador_crecer ( arena, arbol->tuberias, arbol->numTuberias, sizeof(Tuberia) );
+    arbol->numTuberias++;
   }
+  memmove ( &(arbol->tuberias [ posicion + valor->numTuberias ]), &(arbol->tuberias [ posicion + 1 ]),
+            sizeof(Tuberia) * ( arbol->numTuberias - valor->numTuberias - posicion ) );
+  memcpy ( &(arbol->tuberias [ posicion ]), valor->tuberias, sizeof(Tuberia) * valor->numTuberias );
+
+  return anteriores;
+}
 
-  // Reconstrumos la linea reemplazando los aliases.
+void aliases_expandir ( Aliases* aliases, ArbolLinea* arbol, Arena* arena )
+{
+  int t;
   int i;
-  int j;
-  NodoHash* nodo;
-  nuevaLinea[0] = '\0';
-  for ( i = 0; i < info.numProgramas; ++i )
+
+  for ( t = 0; t < arbol->numTuberias; ++t )
   {
-    for ( j = 0; j < info.programas[i].argc; ++j )
+    for ( i = 0; i < arbol->tuberias[t].numComandos; ++i )
     {
-      if ( j == 0 )
+      Comando* comando = &(arbol->tuberias[t].comandos[i]);
+      PartePalabra* nombre;
+      NodoHash* nodo;
+      ArbolLinea valor;
+
+      // Sólo se sustituyen los nombres de programa escritos tal cual.
+      if ( ( comando->numPalabras == 0 ) || ( comando->palabras[0].numPartes != 1 ) )
+        continue;
+      nombre = &(comando->palabras[0].partes[0]);
+      if ( ( nombre->tipo != PARTE_LITERAL ) || nombre->entreComillas )
+        continue;
+
+      nodo = aliases_buscar_nodo ( aliases, nombre->texto );
+      if ( nodo == NULL )
+        continue;
+
+      // El valor del alias se analiza como una linea más. Sus comandos no se
+      // vuelven a expandir, así que saltamos por encima de ellos.
+      if ( ( analizador_procesar ( &valor, nodo->alias.valor, arena ) == -1 ) || ( valor.numTuberias == 0 ) )
+        continue;
+      if ( valor.numTuberias == 1 )
       {
-        // Es un alias?
-        nodo = aliases_buscar_nodo ( aliases, info.programas[i].argv[0] );
-        if ( nodo == NULL )
-        {
-          // No lo es.
-          strcat ( nuevaLinea, info.programas[i].argv[0] );
-          strcat ( nuevaLinea, " " );
-        }
-        else
-        {
-          // S lo es.
-          strcat ( nuevaLinea, nodo->alias.valor );
-          strcat ( nuevaLinea, " " );
-        }
+        i += insertar_alias ( &(arbol->tuberias[t]), i, &(valor.tuberias[0]), arena );
       }
       else
       {
-        strcat ( nuevaLinea, info.programas[i].argv[j] );
-        strcat ( nuevaLinea, " " );
+        i = dividir_tuberia ( arbol, t, i, &valor, arena );
+        t += valor.numTuberias - 1;
       }
     }
-
-    if ( i < ( info.numProgramas - 1 ) )
-    {
-      strcat ( nuevaLinea, "| " );
-    }
   }
-
-  if ( info.ficheroSalida[0] != '\0' )
-  {
-    if ( info.salidaAgregada )
-    {
-      strcat ( nuevaLinea, ">>" );
-    }
-    else
-    {
-      strcat ( nuevaLinea, ">" );
-    }
-    strcat ( nuevaLinea, info.ficheroSalida );
-    strcat ( nuevaLinea, " ");
-  }
-  if ( info.ejecutarEnSpawn )
-  {
-    strcat ( nuevaLinea, "& " );
-  }
-
-  return nuevaLinea;
 }
 
 void aliases_mostrar ( Aliases* aliases, const char* alias )
@@ -27,14 +27,16 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       aliases.h
- * DESCRIPCIN:   Cdigo fuente de los aliases.
+ * DESCRIPCIÓN:   Código fuente de los aliases.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 #pragma once
 
+#include "analizador.h"
+
 struct Aliases_;
 typedef struct Aliases_ Aliases;
 
@@ -44,4 +46,10 @@ void aliases_eliminar ( Aliases* aliases );
 void aliases_establecer ( Aliases* aliases, const char* alias, const char* valor );
 void aliases_eliminar_alias ( Aliases* aliases, const char* alias );
 void aliases_mostrar ( Aliases* aliases, const char* alias );
-char* aliases_procesar_linea ( Aliases* aliases, char* linea, char* nuevaLinea );
+
+// Valor del alias, o NULL si no existe.
+const char* aliases_obtener ( Aliases* aliases, const char* alias );
+
+// Sustituye los nombres de programa de la linea que sean aliases por el valor
+// del alias. Si el valor tiene varias pipelines, se añaden a la lista.
+void aliases_expandir ( Aliases* aliases, ArbolLinea* arbol, Arena* arena );
@@ -0,0 +1,536 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       analizador.c
+ * DESCRIPCIÓN:   Análisis de la linea de comandos en un árbol.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "analizador.h"
+#include "arena.h"
+#include "cadena.h"
+#include "io.h"
+#include "sustitucion.h"
+
+typedef struct
+{
+  Arena* arena;                 // De donde sale la memoria del árbol.
+  const char* p;                // Posición actual en la linea.
+  Palabra palabra;              // Palabra en construcción.
+  Cadena literal;               // Texto literal aún no añadido a la palabra.
+  int literalEntreComillas;
+  int hayLiteral;               // Se añade aunque esté vacío, como en "".
+  int numDocumentos;
+  int silencioso;               // ¿Callar los errores de sintaxis?
+} Analizador;
+
+static void error_sintaxis ( Analizador* a, const char* operador )
+{
+  if ( !a->silencioso )
+    writef ( 2, "error de sintaxis cerca de '%s'\n", operador );
+}
+
+void* analizador_crecer ( Arena* arena, void* vector, int num, size_t tamanyo )
+{
+  if ( ( num & ( num - 1 ) ) == 0 )
+    vector = arena_ampliar ( arena, vector, tamanyo * num, tamanyo * ( ( num == 0 ) ? 1 : ( num * 2 ) ) );
+  return vector;
+}
+
+static void anyadir_parte ( Analizador* a, TipoParte tipo, char* texto, int entreComillas )
+{
+  Palabra* palabra = &(a->palabra);
+  PartePalabra* parte;
+
+  palabra->partes = (PartePalabra *)analizador_crecer ( a->arena, palabra->partes, palabra->numPartes,
+                                                        sizeof(PartePalabra) );
+  parte = &(palabra->partes [ palabra->numPartes++ ]);
+  parte->tipo = tipo;
+  parte->texto = texto;
+  parte->entreComillas = entreComillas;
+  parte->expandida = 0;
+}
+
+static void cerrar_literal ( Analizador* a )
+{
+  if ( a->hayLiteral )
+  {
+    anyadir_parte ( a, PARTE_LITERAL, arena_strdup ( a->arena, a->literal.datos ), a->literalEntreComillas );
+    cadena_vaciar ( &(a->literal) );
+    a->hayLiteral = 0;
+  }
+}
+
+static void anyadir_caracter ( Analizador* a, char c, int entreComillas )
+{
+  // Los trozos literales con y sin comillas van en partes distintas.
+  if ( a->hayLiteral && ( a->literalEntreComillas != entreComillas ) )
+    cerrar_literal ( a );
+
+  cadena_anyadir_caracter ( &(a->literal), c );
+  a->hayLiteral = 1;
+  a->literalEntreComillas = entreComillas;
+}
+
+static void empezar_comillas ( Analizador* a )
+{
+  // Unas comillas vacías forman igualmente un argumento.
+  if ( a->hayLiteral && !a->literalEntreComillas )
+    cerrar_literal ( a );
+  a->hayLiteral = 1;
+  a->literalEntreComillas = 1;
+}
+
+static void leer_dolar ( Analizador* a, int entreComillas )
+{
+  const char* p = a->p;
+  int longitud;
+
+  // $(comando)
+  if ( p[1] == '(' )
+  {
+    longitud = sustitucion_longitud ( p );
+    if ( longitud > 0 )
+    {
+      cerrar_literal ( a );
+      anyadir_parte ( a, PARTE_SUSTITUCION, arena_strndup ( a->arena, p + 2, longitud - 3 ), entreComillas );
+      a->p += longitud;
+      return;
+    }
+  }
+
+  // ${NOMBRE}
+  if ( p[1] == '{' )
+  {
+    const char* fin = strchr ( p + 2, '}' );
+    if ( fin != NULL )
+    {
+      cerrar_literal ( a );
+      anyadir_parte ( a, PARTE_VARIABLE, arena_strndup ( a->arena, p + 2, fin - p - 2 ), entreComillas );
+      a->p = fin + 1;
+      return;
+    }
+  }
+
+  // $? y $NOMBRE
+  if ( p[1] == '?' )
+  {
+    cerrar_literal ( a );
+    anyadir_parte ( a, PARTE_VARIABLE, arena_strdup ( a->arena, "?" ), entreComillas );
+    a->p += 2;
+    return;
+  }
+
+  longitud = 1;
+  while ( isalnum ( (unsigned char)p[longitud] ) || ( p[longitud] == '_' ) )
+    ++longitud;
+  if ( longitud > 1 )
+  {
+    cerrar_literal ( a );
+    anyadir_parte ( a, PARTE_VARIABLE, arena_strndup ( a->arena, p + 1, longitud - 1 ), entreComillas );
+    a->p += longitud;
+    return;
+  }
+
+  // Un $ sin nada detrás es un caracter más.
+  anyadir_caracter ( a, '$', entreComillas );
+  ++a->p;
+}
+
+static int leer_comilla_invertida ( Analizador* a, int entreComillas )
+{
+  int longitud = sustitucion_longitud ( a->p );
+
+  if ( longitud == 0 )
+    return 0;
+
+  cerrar_literal ( a );
+  anyadir_parte ( a, PARTE_SUSTITUCION, arena_strndup ( a->arena, a->p + 1, longitud - 2 ), entreComillas );
+  a->p += longitud;
+  return 1;
+}
+
+static int fin_de_palabra ( char c )
+{
+  return ( c == '\0' ) || ( strchr ( " \t\n|&;<>", c ) != NULL );
+}
+
+static int leer_palabra ( Analizador* a, Palabra* palabra )
+{
+  memset ( &(a->palabra), 0, sizeof(Palabra) );
+
+  while ( !fin_de_palabra ( *a->p ) )
+  {
+    char c = *a->p;
+
+    if ( c == '\'' )
+    {
+      // Entre comillas simples todo es literal.
+      empezar_comillas ( a );
+      for ( ++a->p; ( *a->p != '\0' ) && ( *a->p != '\'' ); ++a->p )
+        anyadir_caracter ( a, *a->p, 1 );
+      if ( *a->p == '\'' )
+        ++a->p;
+    }
+    else if ( c == '"' )
+    {
+      // Entre comillas dobles se expanden variables y sustituciones.
+      empezar_comillas ( a );
+      ++a->p;
+      while ( ( *a->p != '\0' ) && ( *a->p != '"' ) )
+      {
+        if ( ( *a->p == '\\' ) && ( a->p[1] != '\0' ) && ( strchr ( "$`\"\\", a->p[1] ) != NULL ) )
+        {
+          anyadir_caracter ( a, a->p[1], 1 );
+          a->p += 2;
+        }
+        else if ( *a->p == '$' )
+          leer_dolar ( a, 1 );
+        else if ( ( *a->p != '`' ) || !leer_comilla_invertida ( a, 1 ) )
+          anyadir_caracter ( a, *a->p++, 1 );
+      }
+      if ( *a->p == '"' )
+        ++a->p;
+    }
+    else if ( c == '\\' )
+    {
+      // Fuera de comillas, \ hace literal al siguiente caracter.
+      ++a->p;
+      if ( *a->p != '\0' )
+        anyadir_caracter ( a, *a->p++, 1 );
+    }
+    else if ( c == '$' )
+    {
+      leer_dolar ( a, 0 );
+    }
+    else if ( ( c != '`' ) || !leer_comilla_invertida ( a, 0 ) )
+    {
+      anyadir_caracter ( a, c, 0 );
+      ++a->p;
+    }
+  }
+
+  cerrar_literal ( a );
+  *palabra = a->palabra;
+  return ( palabra->numPartes > 0 );
+}
+
+static Tuberia* nueva_tuberia ( ArbolLinea* arbol, Arena* arena, CondicionLista condicion )
+{
+  Tuberia* tuberia;
+
+  arbol->tuberias = (Tuberia *)analizador_crecer ( arena, arbol->tuberias, arbol->numTuberias, sizeof(Tuberia) );
+  tuberia = &(arbol->tuberias [ arbol->numTuberias++ ]);
+  memset ( tuberia, 0, sizeof(Tuberia) );
+  tuberia->condicion = condicion;
+  return tuberia;
+}
+
+static Comando* nuevo_comando ( Tuberia* tuberia, Arena* arena )
+{
+  Comando* comando;
+
+  tuberia->comandos = (Comando *)analizador_crecer ( arena, tuberia->comandos, tuberia->numComandos, sizeof(Comando) );
+  comando = &(tuberia->comandos [ tuberia->numComandos++ ]);
+  memset ( comando, 0, sizeof(Comando) );
+  return comando;
+}
+
+static int comando_vacio ( const Comando* comando )
+{
+  return ( comando->numPalabras == 0 ) && ( comando->numRedirecciones == 0 );
+}
+
+static int cerrar_tuberia ( Analizador* a, ArbolLinea* arbol, const char* comienzo, const char* fin,
+                            CondicionLista siguiente, int segundoPlano, const char* operador )
+{
+  Tuberia* tuberia = &(arbol->tuberias [ arbol->numTuberias - 1 ]);
+
+  if ( comando_vacio ( &(tuberia->comandos [ tuberia->numComandos - 1 ]) ) )
+  {
+    // Un | necesita un comando a cada lado.
+    if ( tuberia->numComandos > 1 )
+    {
+      error_sintaxis ( a, "|" );
+      return -1;
+    }
+
+    // Las pipelines vacías sólo se permiten alrededor de ; y &. A un && o a
+    // un || les tienen que acompañar comandos a ambos lados.
+    if ( ( tuberia->condicion != LISTA_SIEMPRE ) || ( siguiente != LISTA_SIEMPRE ) )
+    {
+      error_sintaxis ( a, operador );
+      return -1;
+    }
+
+    arbol->numTuberias--;
+    return 0;
+  }
+
+  // Guardamos el texto, sin los blancos de los extremos.
+  while ( ( comienzo < fin ) && ( ( *comienzo == ' ' ) || ( *comienzo == '\t' ) ) )
+    ++comienzo;
+  while ( ( fin > comienzo ) && ( ( fin[-1] == ' ' ) || ( fin[-1] == '\t' ) ) )
+    --fin;
+  tuberia->texto = arena_strndup ( a->arena, comienzo, fin - comienzo );
+  tuberia->segundoPlano = segundoPlano;
+  return 0;
+}
+
+static int leer_redireccion ( Analizador* a, Comando* comando )
+{
+  Redireccion* redireccion;
+  Palabra destino;
+  const char* operador;
+  TipoRedireccion tipo;
+
+  if ( strncmp ( a->p, "<<<", 3 ) == 0 )
+  {
+    operador = "<<<";
+    tipo = REDIRECCION_CADENA;
+  }
+  else if ( strncmp ( a->p, "<<-", 3 ) == 0 )
+  {
+    operador = "<<-";
+    tipo = REDIRECCION_DOCUMENTO;
+  }
+  else if ( strncmp ( a->p, "<<", 2 ) == 0 )
+  {
+    operador = "<<";
+    tipo = REDIRECCION_DOCUMENTO;
+  }
+  else if ( strncmp ( a->p, ">>", 2 ) == 0 )
+  {
+    operador = ">>";
+    tipo = REDIRECCION_AGREGAR;
+  }
+  else if ( *a->p == '<' )
+  {
+    operador = "<";
+    tipo = REDIRECCION_ENTRADA;
+  }
+  else
+  {
+    operador = ">";
+    tipo = REDIRECCION_SALIDA;
+  }
+
+  // El destino puede ir pegado al operador o separado por blancos.
+  a->p += strlen ( operador );
+  while ( ( *a->p == ' ' ) || ( *a->p == '\t' ) )
+    ++a->p;
+  if ( !leer_palabra ( a, &destino ) )
+  {
+    error_sintaxis ( a, operador );
+    return -1;
+  }
+
+  comando->redirecciones = (Redireccion *)analizador_crecer ( a->arena, comando->redirecciones,
+                                                              comando->numRedirecciones, sizeof(Redireccion) );
+  redireccion = &(comando->redirecciones [ comando->numRedirecciones++ ]);
+  redireccion->tipo = tipo;
+  redireccion->destino = destino;
+  redireccion->documento = ( tipo == REDIRECCION_DOCUMENTO ) ? a->numDocumentos++ : -1;
+  redireccion->quitarTabuladores = ( strcmp ( operador, "<<-" ) == 0 );
+  return 0;
+}
+
+static int analizar ( ArbolLinea* arbol, const char* linea, Arena* arena, int silencioso )
+{
+  Analizador a;
+  Tuberia* tuberia;
+  Comando* comando;
+  const char* comienzo = linea;
+  int resultado = 0;
+
+  memset ( arbol, 0, sizeof(ArbolLinea) );
+  memset ( &a, 0, sizeof(Analizador) );
+  cadena_inicializar ( &(a.literal) );
+  a.arena = arena;
+  a.p = linea;
+  a.silencioso = silencioso;
+
+  tuberia = nueva_tuberia ( arbol, arena, LISTA_SIEMPRE );
+  comando = nuevo_comando ( tuberia, arena );
+
+  while ( resultado == 0 )
+  {
+    const char* operador = NULL;
+    CondicionLista siguiente = LISTA_SIEMPRE;
+    int segundoPlano = 0;
+    Palabra palabra;
+
+    while ( ( *a.p == ' ' ) || ( *a.p == '\t' ) || ( *a.p == '\n' ) )
+      ++a.p;
+
+    // Un # al comienzo de una palabra comenta el resto de la linea.
+    if ( ( *a.p == '\0' ) || ( *a.p == '#' ) )
+      break;
+
+    if ( strncmp ( a.p, "&&", 2 ) == 0 )
+    {
+      operador = "&&";
+      siguiente = LISTA_SI_EXITO;
+    }
+    else if ( strncmp ( a.p, "||", 2 ) == 0 )
+    {
+      operador = "||";
+      siguiente = LISTA_SI_FALLO;
+    }
+    else if ( *a.p == ';' )
+    {
+      operador = ";";
+    }
+    else if ( *a.p == '&' )
+    {
+      operador = "&";
+      segundoPlano = 1;
+    }
+
+    if ( operador != NULL )
+    {
+      // Fin de la pipeline: la siguiente se ejecutará según esta condición.
+      resultado = cerrar_tuberia ( &a, arbol, comienzo, a.p, siguiente, segundoPlano, operador );
+      a.p += strlen ( operador );
+      comienzo = a.p;
+      tuberia = nueva_tuberia ( arbol, arena, siguiente );
+      comando = nuevo_comando ( tuberia, arena );
+    }
+    else if ( *a.p == '|' )
+    {
+      if ( comando_vacio ( comando ) )
+      {
+        error_sintaxis ( &a, "|" );
+        resultado = -1;
+      }
+      ++a.p;
+      comando = nuevo_comando ( tuberia, arena );
+    }
+    else if ( ( *a.p == '<' ) || ( *a.p == '>' ) )
+    {
+      resultado = leer_redireccion ( &a, comando );
+    }
+    else if ( leer_palabra ( &a, &palabra ) )
+    {
+      comando->palabras = (Palabra *)analizador_crecer ( arena, comando->palabras, comando->numPalabras,
+                                                         sizeof(Palabra) );
+      comando->palabras [ comando->numPalabras++ ] = palabra;
+    }
+  }
+
+  // Un && o || al final de la linea no tiene lado derecho.
+  if ( resultado == 0 )
+  {
+    tuberia = &(arbol->tuberias [ arbol->numTuberias - 1 ]);
+    resultado = cerrar_tuberia ( &a, arbol, comienzo, a.p, LISTA_SIEMPRE, 0,
+                                 ( tuberia->condicion == LISTA_SI_EXITO ) ? "&&" : "||" );
+  }
+
+  cadena_liberar ( &(a.literal) );
+  return resultado;
+}
+
+int analizador_procesar ( ArbolLinea* arbol, const char* linea, Arena* arena )
+{
+  return analizar ( arbol, linea, arena, 0 );
+}
+
+int analizador_procesar_en_silencio ( ArbolLinea* arbol, const char* linea, Arena* arena )
+{
+  return analizar ( arbol, linea, arena, 1 );
+}
+
+static void recorrer_palabra ( Palabra* palabra, TipoParte tipo, FuncionParte funcion, void* contexto )
+{
+  int i;
+
+  for ( i = 0; i < palabra->numPartes; ++i )
+  {
+    if ( palabra->partes[i].tipo == tipo )
+      funcion ( &(palabra->partes[i]), contexto );
+  }
+}
+
+void analizador_recorrer_partes ( Tuberia* tuberia, TipoParte tipo, FuncionParte funcion, void* contexto )
+{
+  int i;
+  int j;
+
+  for ( i = 0; i < tuberia->numComandos; ++i )
+  {
+    Comando* comando = &(tuberia->comandos[i]);
+
+    for ( j = 0; j < comando->numPalabras; ++j )
+      recorrer_palabra ( &(comando->palabras[j]), tipo, funcion, contexto );
+    for ( j = 0; j < comando->numRedirecciones; ++j )
+    {
+      if ( comando->redirecciones[j].tipo != REDIRECCION_DOCUMENTO )
+        recorrer_palabra ( &(comando->redirecciones[j].destino), tipo, funcion, contexto );
+    }
+  }
+}
+
+char* analizador_unir_palabra ( Arena* arena, const Palabra* palabra )
+{
+  char* texto;
+  size_t len = 0;
+  int i;
+
+  for ( i = 0; i < palabra->numPartes; ++i )
+    len += strlen ( palabra->partes[i].texto );
+
+  texto = (char *)arena_reservar ( arena, len + 1 );
+  len = 0;
+  for ( i = 0; i < palabra->numPartes; ++i )
+  {
+    size_t lenParte = strlen ( palabra->partes[i].texto );
+    memcpy ( texto + len, palabra->partes[i].texto, lenParte );
+    len += lenParte;
+  }
+  texto[len] = '\0';
+
+  return texto;
+}
+
+void analizador_anyadir_argumento ( Arena* arena, Comando* comando, char* argumento )
+{
+  // El vector lleva siempre un NULL tras el último argumento.
+  if ( comando->argv == NULL )
+    comando->argv = (char **)arena_reservar ( arena, sizeof(char *) * 2 );
+  else
+    comando->argv = (char **)analizador_crecer ( arena, comando->argv, comando->argc + 1, sizeof(char *) );
+
+  comando->argv [ comando->argc++ ] = argumento;
+  comando->argv [ comando->argc ] = NULL;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       analizador.h
+ * DESCRIPCIÓN:   Análisis de la linea de comandos en un árbol.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "arena.h"
+
+// Trozos de los que se compone una palabra de la linea.
+typedef enum
+{
+  PARTE_LITERAL,                // Texto tal cual.
+  PARTE_VARIABLE,               // $NOMBRE, ${NOMBRE} o $?: el texto es el nombre.
+  PARTE_SUSTITUCION             // $(comando) o `comando`: el texto es el comando.
+} TipoParte;
+
+typedef struct
+{
+  TipoParte tipo;
+  char* texto;
+  int entreComillas;            // Ni se parte en argumentos ni se expanden sus comodines.
+  int expandida;                // Viene de una expansión: fuera de comillas se parte en argumentos.
+} PartePalabra;
+
+typedef struct
+{
+  PartePalabra* partes;
+  int numPartes;
+} Palabra;
+
+typedef enum
+{
+  REDIRECCION_SALIDA,           // >fichero
+  REDIRECCION_AGREGAR,          // >>fichero
+  REDIRECCION_ENTRADA,          // <fichero
+  REDIRECCION_DOCUMENTO,        // <<DELIM y <<-DELIM
+  REDIRECCION_CADENA            // <<<texto
+} TipoRedireccion;
+
+typedef struct
+{
+  TipoRedireccion tipo;
+  Palabra destino;              // Fichero, delimitador o texto.
+  int documento;                // Número del here-document dentro de la linea.
+  int quitarTabuladores;        // Operador <<-: se quitan los tabuladores iniciales.
+} Redireccion;
+
+// Comando simple: sus palabras y redirecciones tal y como se escribieron y,
+// una vez expandido, los argumentos con los que ejecutarlo.
+typedef struct
+{
+  Palabra* palabras;
+  int numPalabras;
+  Redireccion* redirecciones;
+  int numRedirecciones;
+
+  char** argv;
+  int argc;
+
+  // Argumentos que salieron del comodín con más resultados. Si el comando se
+  // ejecuta por lotes, son los que se reparten entre las ejecuciones.
+  int inicioComodin;
+  int numComodin;
+} Comando;
+
+// Condición para ejecutar una pipeline de la lista, según el código de salida
+// del último comando ejecutado.
+typedef enum
+{
+  LISTA_SIEMPRE,                // Tras ; o &, o la primera de la lista.
+  LISTA_SI_EXITO,               // Tras &&.
+  LISTA_SI_FALLO                // Tras ||.
+} CondicionLista;
+
+// Comandos unidos por |, que se ejecutan como un único trabajo.
+typedef struct
+{
+  Comando* comandos;
+  int numComandos;
+  char* texto;                  // Texto original, para identificar al trabajo.
+  CondicionLista condicion;
+  int segundoPlano;             // ¿Terminaba en &?
+} Tuberia;
+
+typedef struct
+{
+  Tuberia* tuberias;
+  int numTuberias;
+} ArbolLinea;
+
+// Analiza la linea de una sola pasada. Devuelve -1, tras informar del error,
+// si la sintaxis no es correcta. Todo el árbol, y lo que después se añada al
+// expandirlo, sale de la arena, y se libera de una vez al vaciarla.
+int analizador_procesar ( ArbolLinea* arbol, const char* linea, Arena* arena );
+
+// Igual, pero sin informar de los errores: para echar un vistazo a la linea
+// antes de ejecutarla, que es cuando se informa de ellos.
+int analizador_procesar_en_silencio ( ArbolLinea* arbol, const char* linea, Arena* arena );
+
+// Llama a la función con cada parte del tipo dado de las palabras y los
+// destinos de las redirecciones de la pipeline. Los delimitadores de los
+// here-documents no se expanden, así que no se recorren.
+typedef void (*FuncionParte) ( PartePalabra* parte, void* contexto );
+void analizador_recorrer_partes ( Tuberia* tuberia, TipoParte tipo, FuncionParte funcion, void* contexto );
+
+// Une las partes de una palabra, sin partirla ni expandir comodines.
+char* analizador_unir_palabra ( Arena* arena, const Palabra* palabra );
+
+// Añade un argumento a los argumentos expandidos.
+void analizador_anyadir_argumento ( Arena* arena, Comando* comando, char* argumento );
+
+// Hace sitio para un elemento más en un vector de num elementos. Los vectores
+// crecen al doble cada vez que su tamaño llega a una potencia de dos, por lo
+// que no hace falta guardar su capacidad.
+void* analizador_crecer ( Arena* arena, void* vector, int num, size_t tamanyo );
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       arena.c
+ * DESCRIPCIÓN:   Memoria por bloques que se libera toda de una vez.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "config.h"
+
+// Todas las reservas quedan alineadas para cualquier tipo.
+#define ARENA_ALINEAMIENTO ( sizeof(long double) > sizeof(void *) ? sizeof(long double) : sizeof(void *) )
+#define ARENA_ALINEAR(n) ( ( (n) + ARENA_ALINEAMIENTO - 1 ) & ~( ARENA_ALINEAMIENTO - 1 ) )
+
+struct BloqueArena_
+{
+  BloqueArena* siguiente;
+  size_t tamanyo;
+  size_t usado;
+  long double datos[];
+};
+
+static BloqueArena* nuevo_bloque ( size_t tamanyo )
+{
+  BloqueArena* bloque;
+
+  // Las reservas mayores que un bloque normal tienen uno a su medida.
+  if ( tamanyo < ARENA_TAMANYO_BLOQUE )
+    tamanyo = ARENA_TAMANYO_BLOQUE;
+
+  bloque = (BloqueArena *)malloc ( sizeof(BloqueArena) + tamanyo );
+  bloque->siguiente = NULL;
+  bloque->tamanyo = tamanyo;
+  bloque->usado = 0;
+  return bloque;
+}
+
+void arena_inicializar ( Arena* arena )
+{
+  arena->primero = NULL;
+  arena->actual = NULL;
+}
+
+void arena_liberar ( Arena* arena )
+{
+  BloqueArena* bloque;
+  BloqueArena* siguiente;
+
+  for ( bloque = arena->primero; bloque != NULL; bloque = siguiente )
+  {
+    siguiente = bloque->siguiente;
+    free ( bloque );
+  }
+  arena_inicializar ( arena );
+}
+
+void arena_vaciar ( Arena* arena )
+{
+  BloqueArena* bloque;
+  BloqueArena* siguiente;
+
+  if ( arena->primero == NULL )
+    return;
+
+  for ( bloque = arena->primero->siguiente; bloque != NULL; bloque = siguiente )
+  {
+    siguiente = bloque->siguiente;
+    free ( bloque );
+  }
+  arena->primero->siguiente = NULL;
+  arena->primero->usado = 0;
+  arena->actual = arena->primero;
+}
+
+void* arena_reservar ( Arena* arena, size_t tamanyo )
+{
+  BloqueArena* bloque = arena->actual;
+  char* datos;
+
+  tamanyo = ARENA_ALINEAR ( tamanyo );
+  if ( ( bloque == NULL ) || ( bloque->usado + tamanyo > bloque->tamanyo ) )
+  {
+    // Lo que quede libre en el bloque actual se pierde hasta vaciar la arena.
+    BloqueArena* nuevo = nuevo_bloque ( tamanyo );
+    if ( bloque == NULL )
+      arena->primero = nuevo;
+    else
+      bloque->siguiente = nuevo;
+    arena->actual = nuevo;
+    bloque = nuevo;
+  }
+
+  datos = (char *)bloque->datos + bloque->usado;
+  bloque->usado += tamanyo;
+  return datos;
+}
+
+void* arena_ampliar ( Arena* arena, void* datos, size_t tamanyo, size_t nuevoTamanyo )
+{
+  BloqueArena* bloque = arena->actual;
+  void* nuevo;
+
+  if ( datos == NULL )
+    return arena_reservar ( arena, nuevoTamanyo );
+
+  // Si es la última reserva del bloque actual, basta con mover el final.
+  tamanyo = ARENA_ALINEAR ( tamanyo );
+  nuevoTamanyo = ARENA_ALINEAR ( nuevoTamanyo );
+  if ( ( bloque != NULL ) && ( (char *)datos + tamanyo == (char *)bloque->datos + bloque->usado ) &&
+       ( bloque->usado - tamanyo + nuevoTamanyo <= bloque->tamanyo ) )
+  {
+    bloque->usado = bloque->usado - tamanyo + nuevoTamanyo;
+    return datos;
+  }
+
+  nuevo = arena_reservar ( arena, nuevoTamanyo );
+  memcpy ( nuevo, datos, ( tamanyo < nuevoTamanyo ) ? tamanyo : nuevoTamanyo );
+  return nuevo;
+}
+
+char* arena_strndup ( Arena* arena, const char* texto, size_t n )
+{
+  char* copia;
+  size_t len = strnlen ( texto, n );
+
+  copia = (char *)arena_reservar ( arena, len + 1 );
+  memcpy ( copia, texto, len );
+  copia[len] = '\0';
+  return copia;
+}
+
+char* arena_strdup ( Arena* arena, const char* texto )
+{
+  return arena_strndup ( arena, texto, strlen ( texto ) );
+}
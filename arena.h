@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       arena.h
+ * DESCRIPCIÓN:   Memoria por bloques que se libera toda de una vez.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+struct BloqueArena_;
+typedef struct BloqueArena_ BloqueArena;
+
+// Las reservas se toman consecutivamente de bloques grandes y no se liberan
+// por separado: toda la memoria se devuelve de una vez al vaciar la arena.
+// Una arena a cero es válida y no reserva nada hasta que se usa.
+typedef struct
+{
+  BloqueArena* primero;
+  BloqueArena* actual;
+} Arena;
+
+void arena_inicializar ( Arena* arena );
+void arena_liberar ( Arena* arena );
+
+// Da por libre toda la memoria de la arena. Se conserva el primer bloque
+// para las siguientes reservas, y se liberan los demás para que una reserva
+// puntual grande no se quede ocupando memoria.
+void arena_vaciar ( Arena* arena );
+
+void* arena_reservar ( Arena* arena, size_t tamanyo );
+
+// Amplía una reserva hecha en la arena conservando su contenido. Si es la
+// última reserva y cabe en su bloque, se amplía sin moverla.
+void* arena_ampliar ( Arena* arena, void* datos, size_t tamanyo, size_t nuevoTamanyo );
+
+char* arena_strdup ( Arena* arena, const char* texto );
+char* arena_strndup ( Arena* arena, const char* texto, size_t n );
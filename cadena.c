@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       cadena.c
+ * DESCRIPCIÓN:   Cadenas de caracteres de tamaño dinámico.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "cadena.h"
+
+#define CADENA_TAMANYO_INICIAL 64
+
+void cadena_inicializar ( Cadena* cadena )
+{
+  cadena->capacidad = CADENA_TAMANYO_INICIAL;
+  cadena->datos = (char *)malloc ( cadena->capacidad );
+  cadena->datos[0] = '\0';
+  cadena->len = 0;
+}
+
+void cadena_liberar ( Cadena* cadena )
+{
+  free ( cadena->datos );
+  cadena->datos = NULL;
+  cadena->len = 0;
+  cadena->capacidad = 0;
+}
+
+void cadena_vaciar ( Cadena* cadena )
+{
+  cadena->len = 0;
+  cadena->datos[0] = '\0';
+}
+
+void cadena_reservar ( Cadena* cadena, int n )
+{
+  // Nos aseguramos de que quepan n caracteres más y el fin de cadena,
+  // duplicando la capacidad para que añadir sea O(1) amortizado.
+  if ( ( cadena->len + n + 1 ) > cadena->capacidad )
+  {
+    int capacidad = cadena->capacidad * 2;
+    if ( capacidad < ( cadena->len + n + 1 ) )
+      capacidad = cadena->len + n + 1;
+
+    cadena->datos = (char *)realloc ( cadena->datos, capacidad );
+    cadena->capacidad = capacidad;
+  }
+}
+
+void cadena_anyadir_n ( Cadena* cadena, const char* texto, int n )
+{
+  cadena_reservar ( cadena, n );
+  memcpy ( &(cadena->datos[cadena->len]), texto, n );
+  cadena->len += n;
+  cadena->datos[cadena->len] = '\0';
+}
+
+void cadena_anyadir ( Cadena* cadena, const char* texto )
+{
+  cadena_anyadir_n ( cadena, texto, strlen ( texto ) );
+}
+
+void cadena_anyadir_caracter ( Cadena* cadena, char c )
+{
+  cadena_anyadir_n ( cadena, &c, 1 );
+}
@@ -26,41 +26,29 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  *
- * FICHERO:       infolinea.h
- * DESCRIPCIN:   Procesado de la linea de comandos. 
+ * FICHERO:       cadena.h
+ * DESCRIPCIÓN:   Cadenas de caracteres de tamaño dinámico.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - Código fuente inicial.
  */
 
 #pragma once
 
-#include "config.h"
-
-typedef struct
-{
-  // Informacin acerca de los programas encadenados por pipes.
-  struct
-  {
-    int argc;
-    char* argv[MAX_ARGS];
-    int pipe_io[2]; // Pipe para redireccionar la salida estndar de un programa a la entrada del siguiente.
-  } programas [ MAX_PROGRAMAS_POR_LINEA ];
-  int numProgramas;
-
-  // Debe ejecutarse en modo spawn?
-  int ejecutarEnSpawn;
-
-  // Redirigir la salida estndar a un fichero?
-  char ficheroSalida [ 256 ];
-  int salidaAgregada;
-} InfoLinea;
-
+// Cadena que crece geométricamente según se le añade contenido. El contenido
+// está siempre terminado en '\0', por lo que datos puede usarse como string.
 typedef struct
 {
-  int programa;
-  int argumento;
-} InfoLineaCursor;
+  char* datos;
+  int len;
+  int capacidad;
+} Cadena;
 
-void infolinea_procesar ( InfoLinea* info, char* linea, InfoLineaCursor* infoCursor, int posicionCursor );
+void cadena_inicializar ( Cadena* cadena );
+void cadena_liberar ( Cadena* cadena );
+void cadena_vaciar ( Cadena* cadena );
+void cadena_reservar ( Cadena* cadena, int n );
+void cadena_anyadir ( Cadena* cadena, const char* texto );
+void cadena_anyadir_n ( Cadena* cadena, const char* texto, int n );
+void cadena_anyadir_caracter ( Cadena* cadena, char c );
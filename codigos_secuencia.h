@@ -27,16 +27,17 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       codigos_secuencia.h
- * DECRIPCIN:    Enumeracin de las secuencias de escape conocidas.
+ * DECRIPCIÓN:    Enumeración de las secuencias de escape conocidas.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 #pragma once
 
 typedef enum
 {
+  // Teclas: secuencias que envía el terminal.
   // Navegacion
   FLECHA_ARRIBA = 0,
   FLECHA_ABAJO,
@@ -47,12 +48,37 @@ typedef enum
   PAGINA_ARRIBA,
   PAGINA_ABAJO,
 
+  // Edicion
+  LINEA_SUPRIMIR,
+
+  // Pegado (bracketed paste)
+  PEGADO_INICIO,
+  PEGADO_FIN,
+
+  TECLAS_MAXIMA,              // Marcador del final de las teclas. NO MODIFICAR.
+
+  // Secuencias que se envían al terminal.
+  // Cursor y pantalla
+  CURSOR_IZQUIERDA,
+  CURSOR_DERECHA,
+  CURSOR_IZQUIERDA_N,         // Parametrizada: número de columnas.
+  CURSOR_DERECHA_N,           // Parametrizada: número de columnas.
+  CURSOR_COLUMNA,             // Parametrizada: columna, comenzando en 0.
+  PANTALLA_LIMPIAR,
+
   // Lineas
   LINEA_LIMPIAR_DERECHA,
   LINEA_LIMPIAR_IZQUIERDA,
   LINEA_LIMPIAR_ENTERA,
-  LINEA_SUPRIMIR,
 
+  // Pegado (bracketed paste)
+  PEGADO_ACTIVAR,
+  PEGADO_DESACTIVAR,
+
+  // Atributos del texto
+  ATRIBUTOS_NORMALES,
+  ATRIBUTO_NEGRITA,
+  COLOR_TEXTO,                // Parametrizada: color ANSI, de 0 a 7.
 
   // Valores especiales. NO MODIFICAR.
   SECUENCIA_MAXIMA,           // Marcador del numero de secuencias existentes.
@@ -60,4 +86,3 @@ typedef enum
   SECUENCIA_INEXISTENTE,      // No se han encontrado secuencias coincidentes.
   SECUENCIA_NO_FINALIZADA     // Coincide parcialmente, pero aun necesitamos leer mas datos.
 } CodigoSecuencia;
-
@@ -27,27 +27,40 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       comandos.c
- * DESCRIPCIN:   Ejecucin de los comandos introducidos y comandos internos.
+ * DESCRIPCIÓN:   Ejecución de los comandos introducidos y comandos internos.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #include "aliases.h"
+#include "analizador.h"
+#include "arena.h"
 #include "comandos.h"
 #include "comodines.h"
+#include "eventos.h"
 #include "historial.h"
-#include "infolinea.h"
 #include "io.h"
+#include "lanzador.h"
+#include "latencia.h"
+#include "lotes.h"
+#include "paralelo.h"
+#include "resaltado.h"
+#include "rutas.h"
+#include "sustitucion.h"
+#include "trabajos.h"
+#include "tuberias.h"
 #include "variables.h"
 
 static struct
@@ -57,6 +70,10 @@ static struct
 } comandos_internos [ 128 ];
 static int numComandosInternos = 0;
 
+// Código de salida que deja un comando interno en $?, si no es el que se
+// deduce de su CommandState (por ejemplo, fg deja el del trabajo).
+static int codigoComandoInterno = -1;
+
 static CommandState ejecutar_comando_interno ( int argc, char* argv[] );
 int es_comando_interno ( const char* comando )
 {
@@ -73,14 +90,99 @@ int es_comando_interno ( const char* comando )
   return esInterno;
 }
 
-CommandState procesar_comando ( char* line, char* envp[], Variables* vars, Aliases* aliases )
+static CommandState ejecutar_linea ( Tuberia* tuberia, Variables* vars, Documentos* docs );
+
+// Memoria del árbol de la linea y de sus expansiones. Se vacía de una vez al
+// terminar cada linea, así que en uso normal no se reserva memoria por comando.
+static Arena arenaComando;
+
+// Lo que necesita el subshell de una sustitución de comandos.
+typedef struct
+{
+  Variables* vars;
+  Aliases* aliases;
+} ContextoSubshell;
+
+static CommandState ejecutar_lista ( char* line, Variables* vars, Aliases* aliases, Documentos* docs );
+
+static int ejecutar_subshell ( char* comando, void* contexto )
+{
+  ContextoSubshell* subshell = (ContextoSubshell *)contexto;
+  const char* codigo;
+
+  ejecutar_lista ( comando, subshell->vars, subshell->aliases, NULL );
+  codigo = variables_obtener ( subshell->vars, "?" );
+  return ( codigo != NULL ) ? atoi ( codigo ) : 0;
+}
+
+static CommandState ejecutar_elemento ( Tuberia* tuberia, Variables* vars, Aliases* aliases, Documentos* docs )
+{
+  ContextoSubshell subshell;
+
+  // Cada pipeline de la lista se expande justo antes de ejecutarla, para que
+  // vea el resultado de las anteriores (por ejemplo, en $?). Las expansiones
+  // son pasadas sobre el árbol, sin volver a analizar la linea.
+
+  // Sustituimos los $(comando) y `comando` por su salida.
+  subshell.vars = vars;
+  subshell.aliases = aliases;
+  sustitucion_expandir ( tuberia, &arenaComando, ejecutar_subshell, &subshell );
+
+  // Reemplazamos las variables.
+  variables_expandir ( vars, tuberia, &arenaComando );
+
+  // Si era una asignación de variables, paramos.
+  if ( variables_asignar ( vars, tuberia ) )
+  {
+    variables_establecer ( vars, "?", "0" );
+    return COMANDO_OK;
+  }
+
+  // Generamos los argumentos, reemplazando los comodines.
+  comodines_expandir ( tuberia, &arenaComando );
+
+  return ejecutar_linea ( tuberia, vars, docs );
+}
+
+static CommandState ejecutar_lista ( char* line, Variables* vars, Aliases* aliases, Documentos* docs )
 {
-  int i;
-  InfoLinea info;
   CommandState state = COMANDO_OK;
-  CommandState stateComandoInterno;
+  ArbolLinea arbol;
+  int i;
+
+  // Analizamos una sola vez la linea completa, con su lista de pipelines
+  // (;, &, && y ||), y las ejecutamos en orden, saltando las que no cumplan
+  // su condición.
+  if ( analizador_procesar ( &arbol, line, &arenaComando ) == -1 )
+  {
+    variables_establecer ( vars, "?", "2" );
+    return COMANDO_ERROR;
+  }
+
+  // Los aliases se sustituyen antes de empezar, porque su valor puede añadir
+  // pipelines a la lista.
+  aliases_expandir ( aliases, &arbol, &arenaComando );
+
+  for ( i = 0; ( i < arbol.numTuberias ) && ( state != COMANDO_SALIR ); ++i )
+  {
+    const char* codigo = variables_obtener ( vars, "?" );
+    int exito = ( codigo == NULL ) || ( strcmp ( codigo, "0" ) == 0 );
+
+    if ( ( ( arbol.tuberias[i].condicion == LISTA_SI_EXITO ) && !exito ) ||
+         ( ( arbol.tuberias[i].condicion == LISTA_SI_FALLO ) && exito ) )
+      continue;
+
+    state = ejecutar_elemento ( &(arbol.tuberias[i]), vars, aliases, docs );
+  }
+
+  return state;
+}
+
+CommandState procesar_comando ( char* line, char* envp[], Variables* vars, Aliases* aliases, Documentos* docs )
+{
+  CommandState state;
   Historial* hist = historial_obtener_instancia ();
-  pid_t ultimoHijo;
+  Cadena lineaHistorial;
 
   if ( line[0] == '\0' )
   {
@@ -88,193 +190,336 @@ CommandState procesar_comando ( char* line, char* envp[], Variables* vars, Alias
     return COMANDO_OK;
   }
 
-  else if ( line[0] == '!' )
+  cadena_inicializar ( &lineaHistorial );
+
+  if ( line[0] == '!' )
   {
     // Busqueda en el historial.
     char* newLine = historial_empieza_por ( hist, &(line[1]) );
     if ( newLine )
     {
       writef ( 1, "%s\n", newLine );
-      strcpy ( line, newLine );
+      cadena_anyadir ( &lineaHistorial, newLine );
+      line = lineaHistorial.datos;
     }
   }
 
-  // Agregamos la linea leda al historial.
+  // Agregamos la linea leída al historial.
   historial_anyadir ( hist, line );
 
-  // Reemplazamos los comodines.
-  char nuevaLinea [ 1024 ];
-  line = reemplazar_comodines ( line, nuevaLinea );
+  state = ejecutar_lista ( line, vars, aliases, docs );
 
-  // Reemplazamos las variables.
-  char nuevaLinea2 [ 1024 ];
-  line = variables_procesar_linea ( vars, line, nuevaLinea2 );
-  if ( line[0] == '\0' )
+  arena_vaciar ( &arenaComando );
+  cadena_liberar ( &lineaHistorial );
+
+  return state;
+}
+
+static pid_t lanzar_comando_interno ( int argc, char* argv[], const Redirecciones* redirecciones, pid_t grupo )
+{
+  CommandState state = COMANDO_ERROR;
+  pid_t pid = fork ();
+
+  switch ( pid )
   {
-    // Era una asignacin de variables, paramos.
-    return COMANDO_OK;
+    case -1:
+      perror("fork");
+      break;
+    case 0:
+      // El comando no debe heredar las señales bloqueadas por el shell.
+      trabajos_restaurar_hijo ( grupo );
+      eventos_restaurar_hijo ();
+
+      if ( lanzador_redirigir ( redirecciones ) == 0 )
+        state = ejecutar_comando_interno ( argc, argv );
+
+      exit ( state );
+      break;
   }
 
-  // Reemplazamos los alises.
-  char nuevaLinea3 [ 1024 ];
-  line = aliases_procesar_linea ( aliases, line, nuevaLinea3 );
+  return pid;
+}
+
+static void establecer_codigo_salida ( Variables* vars, int codigo )
+{
+  char str [ 16 ];
+  sprintf ( str, "%d", codigo );
+  variables_establecer ( vars, "?", str );
+}
+
+static void quitar_prefijo ( Comando* comando, int numArgumentos )
+{
+  // Desplazamos los argumentos, incluido el NULL final.
+  memmove ( &(comando->argv[0]), &(comando->argv[numArgumentos]),
+            sizeof(char *) * ( comando->argc - numArgumentos + 1 ) );
+  comando->argc -= numArgumentos;
+  comando->inicioComodin -= numArgumentos;
+}
+
+// Lo que necesita cada comando de la pipeline para lanzarse.
+typedef struct
+{
+  int pipe_io[2];               // Pipe hacia el siguiente comando.
+  int entrada;                  // Entrada preparada por una redirección, o -1.
+  char* ficheroSalida;          // Fichero al que redirigir la salida, o NULL.
+  int salidaAgregada;
+} EstadoComando;
+
+static int preparar_redirecciones ( Comando* comando, Documentos* docs, EstadoComando* estado )
+{
+  int i;
+
+  // Se aplican en orden, de forma que la última de cada tipo es la que vale.
+  for ( i = 0; i < comando->numRedirecciones; ++i )
+  {
+    Redireccion* redireccion = &(comando->redirecciones[i]);
+    char* destino = analizador_unir_palabra ( &arenaComando, &(redireccion->destino) );
+    const Cadena* cuerpo;
+    int entrada = -1;
 
-  // Extraemos la informacin de la lnea.
-  infolinea_procesar ( &info, line, NULL, -1 );
+    switch ( redireccion->tipo )
+    {
+      case REDIRECCION_SALIDA:
+      case REDIRECCION_AGREGAR:
+        estado->ficheroSalida = destino;
+        estado->salidaAgregada = ( redireccion->tipo == REDIRECCION_AGREGAR );
+        continue;
+
+      case REDIRECCION_ENTRADA:
+        entrada = open ( destino, O_RDONLY | O_CLOEXEC );
+        if ( entrada == -1 )
+          writef ( 2, "%s: %s\n", destino, strerror ( errno ) );
+        break;
+
+      case REDIRECCION_DOCUMENTO:
+        cuerpo = documentos_obtener ( docs, redireccion->documento );
+        entrada = documentos_crear_entrada ( cuerpo ? cuerpo->datos : "", cuerpo ? cuerpo->len : 0 );
+        if ( entrada == -1 )
+          perror ( "here-document" );
+        break;
+
+      case REDIRECCION_CADENA:
+        // El here-string llega al programa con un salto de linea final.
+        destino = (char *)arena_ampliar ( &arenaComando, destino, strlen ( destino ) + 1, strlen ( destino ) + 2 );
+        strcat ( destino, "\n" );
+        entrada = documentos_crear_entrada ( destino, strlen ( destino ) );
+        if ( entrada == -1 )
+          perror ( "here-string" );
+        break;
+    }
+
+    if ( entrada == -1 )
+      return -1;
+    if ( estado->entrada != -1 )
+      close ( estado->entrada );
+    estado->entrada = entrada;
+  }
 
-  // Si slo tenemos un programa, es un comando interno, y no hay redirecciones,
-  // lo ejecutamos dirctamente en el padre.
-  if ( ( info.numProgramas == 1 ) &&
-       ( es_comando_interno ( info.programas[0].argv[0] ) == 1 ) &&
-       ( info.ficheroSalida[0] == '\0' )
+  return 0;
+}
+
+static void liberar_estados ( EstadoComando* estados, int numComandos )
+{
+  int i;
+
+  for ( i = 0; i < numComandos; ++i )
+  {
+    if ( estados[i].entrada != -1 )
+      close ( estados[i].entrada );
+  }
+}
+
+static CommandState ejecutar_linea ( Tuberia* tuberia, Variables* vars, Documentos* docs )
+{
+  int i;
+  CommandState state = COMANDO_OK;
+  pid_t ultimoHijo = -1;
+  Comando* comandos = tuberia->comandos;
+  int numComandos = tuberia->numComandos;
+  EstadoComando* estados;
+
+  int tamanyoPipes = tuberias_obtener_tamanyo ();
+  int medir = 0;
+
+  // Prefijos de la linea, en cualquier orden:
+  // - "time": mide cada programa de la linea al terminar.
+  // - "pipesize tamaño": los pipes de esta linea usan ese tamaño.
+  for ( ;; )
+  {
+    Comando* primero = &(comandos[0]);
+
+    if ( ( primero->argc > 1 ) && ( strcmp ( primero->argv[0], "time" ) == 0 ) )
+    {
+      medir = 1;
+      quitar_prefijo ( primero, 1 );
+    }
+    else if ( ( primero->argc > 2 ) && ( strcmp ( primero->argv[0], "pipesize" ) == 0 ) )
+    {
+      tamanyoPipes = tuberias_interpretar_tamanyo ( primero->argv[1] );
+      if ( tamanyoPipes == -1 )
+      {
+        writef ( 2, "pipesize: %s: tamaño no válido\n", primero->argv[1] );
+        establecer_codigo_salida ( vars, 2 );
+        return COMANDO_ERROR;
+      }
+      quitar_prefijo ( primero, 2 );
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  // Un comando que se queda sin argumentos al expandirse no ejecuta nada.
+  for ( i = 0; i < numComandos; ++i )
+  {
+    if ( comandos[i].argc == 0 )
+    {
+      if ( numComandos > 1 )
+      {
+        writef ( 2, "comando vacío en la pipeline\n" );
+        establecer_codigo_salida ( vars, 2 );
+        return COMANDO_ERROR;
+      }
+      establecer_codigo_salida ( vars, 0 );
+      return COMANDO_OK;
+    }
+  }
+
+  // Preparamos las redirecciones antes de lanzar nada.
+  estados = (EstadoComando *)arena_reservar ( &arenaComando, sizeof(EstadoComando) * numComandos );
+  memset ( estados, 0, sizeof(EstadoComando) * numComandos );
+  for ( i = 0; i < numComandos; ++i )
+    estados[i].entrada = -1;
+  for ( i = 0; i < numComandos; ++i )
+  {
+    if ( preparar_redirecciones ( &(comandos[i]), docs, &(estados[i]) ) == -1 )
+    {
+      liberar_estados ( estados, numComandos );
+      establecer_codigo_salida ( vars, 1 );
+      return COMANDO_ERROR;
+    }
+  }
+
+  // Si sólo tenemos un programa, es un comando interno, y no hay redirecciones,
+  // lo ejecutamos diréctamente en el padre. Con time lo ejecutamos en un hijo
+  // para poder medirlo como a los demás.
+  if ( ( numComandos == 1 ) && !medir &&
+       ( es_comando_interno ( comandos[0].argv[0] ) == 1 ) &&
+       ( comandos[0].numRedirecciones == 0 )
      )
   {
-    char str[8];
-    state = ejecutar_comando_interno ( info.programas[0].argc, info.programas[0].argv );
-    sprintf ( str, "%d", (int)state );
-    variables_establecer ( vars, "?", str );
+    codigoComandoInterno = -1;
+    state = ejecutar_comando_interno ( comandos[0].argc, comandos[0].argv );
+    if ( codigoComandoInterno == -1 )
+      codigoComandoInterno = ( state == COMANDO_ERROR ) ? 1 : 0;
+    establecer_codigo_salida ( vars, codigoComandoInterno );
   }
   else
   {
+    // Todos los procesos de la linea forman un trabajo.
+    Trabajo* trabajo = trabajos_crear ( tuberia->texto );
+    if ( medir )
+      trabajos_medir ( trabajo );
+
     // Creamos un proceso hijo por cada comando a procesar.
-    for ( i = 0; i < info.numProgramas; ++i )
+    for ( i = 0; i < numComandos; ++i )
     {
+      Redirecciones redirecciones;
+
       // Generamos los pipes para la cadena.
-      if ( ( i + 1 ) != info.numProgramas )
+      if ( ( i + 1 ) != numComandos )
       {
-        if ( pipe ( info.programas[i].pipe_io ) == -1 )
+        // Con O_CLOEXEC ningún programa hereda los extremos de los demás, y
+        // el fin de fichero llega en cuanto termina el que escribe.
+        if ( tuberias_crear ( estados[i].pipe_io, tamanyoPipes ) == -1 )
         {
-          perror("pipe");
-          return COMANDO_ERROR;
+          perror("pipe2");
+          if ( i > 0 )
+            close ( estados[i - 1].pipe_io[0] );
+          state = COMANDO_ERROR;
+          ultimoHijo = -1;
+          break;
         }
       }
 
-      ultimoHijo = fork ();
-      switch ( ultimoHijo )
+      // Redireccionamos la entrada y salida estándar cuando sea apropiado.
+      redirecciones.entrada = ( i > 0 ) ? estados[i - 1].pipe_io[0] : -1;
+      if ( estados[i].entrada != -1 )
+        redirecciones.entrada = estados[i].entrada;
+      redirecciones.salida = -1;
+      redirecciones.cerrar = -1;
+      if ( ( i + 1 ) != numComandos )
       {
-        case -1:
-          perror("fork");
-          state = COMANDO_ERROR;
-          break;
-        case 0:
+        redirecciones.salida = estados[i].pipe_io[1];
+        redirecciones.cerrar = estados[i].pipe_io[0];
+      }
+      redirecciones.ficheroSalida = estados[i].ficheroSalida;
+      redirecciones.salidaAgregada = estados[i].salidaAgregada;
+
+      // Los programas externos se lanzan con posix_spawn. Sólo los comandos
+      // internos necesitan una copia del shell en la que ejecutarse.
+      if ( es_comando_interno ( comandos[i].argv[0] ) )
+      {
+        ultimoHijo = lanzar_comando_interno ( comandos[i].argc, comandos[i].argv,
+                                              &redirecciones, trabajos_grupo ( trabajo ) );
+      }
+      else
+      {
+        if ( lotes_activados () && lotes_necesarios ( comandos[i].argv, comandos[i].argc ) )
         {
-          // Redireccionamos la entrada y salida estndar cuando sea apropiado.
-          if ( ( i + 1 ) != info.numProgramas )
-          {
-            if ( close(1) == -1 )
-            {
-              perror("close");
-              exit ( COMANDO_ERROR );
-            }
-            if ( dup ( info.programas[i].pipe_io[1] ) != 1 )
-            {
-              perror("dup");
-              exit ( COMANDO_ERROR );
-            }
-            if ( close ( info.programas[i].pipe_io[1] ) == -1 || close ( info.programas[i].pipe_io[0] ) == -1 )
-            {
-              perror("close");
-              exit ( COMANDO_ERROR );
-            }
-          }
-          if ( i > 0 )
-          {
-            if ( close(0) == -1 )
-            {
-              perror("close");
-              exit ( COMANDO_ERROR );
-            }
-            if ( dup ( info.programas[i - 1].pipe_io[0] ) != 0 )
-            {
-              perror("dup");
-              exit ( COMANDO_ERROR );
-            }
-            if ( close ( info.programas[i - 1].pipe_io[0] ) == -1 )
-            {
-              perror("close");
-              exit ( COMANDO_ERROR );
-            }
-          }
-          if ( (i == ( info.numProgramas - 1 )) && (info.ficheroSalida[0] != '\0') )
-          {
-            int flags;
-
-            if ( close(1) == -1 )
-            {
-              perror("close");
-              exit ( COMANDO_ERROR );
-            }
-
-            flags = O_WRONLY | O_CREAT;
-            if ( info.salidaAgregada )
-              flags |= O_APPEND;
-            else
-              flags |= O_TRUNC;
-
-            if ( open ( info.ficheroSalida, flags, S_IREAD|S_IWRITE ) != 1 )
-            {
-              perror("open");
-              exit ( COMANDO_ERROR );
-            }
-          }
-
-          // Comprobamos si es un comando interno.
-          stateComandoInterno = ejecutar_comando_interno ( info.programas[i].argc, info.programas[i].argv );
-          if ( stateComandoInterno != COMANDO_INTERNO_INEXISTENTE )
-          {
-            state = stateComandoInterno;
-          }
-          else
-          {
-            execvp ( info.programas[i].argv[0], info.programas[i].argv );
-            perror ( "execvp" );
-            state = COMANDO_ERROR;
-          }
-
-          exit ( state );
-          break;
+          // Los argumentos no caben: lo ejecutamos por lotes, como xargs.
+          ultimoHijo = lotes_ejecutar ( comandos[i].argv, comandos[i].argc, comandos[i].inicioComodin,
+                                        comandos[i].numComodin, &redirecciones, trabajos_grupo ( trabajo ) );
+        }
+        else
+        {
+          ultimoHijo = lanzador_ejecutar ( comandos[i].argv, &redirecciones, trabajos_grupo ( trabajo ) );
         }
       }
 
+      if ( ultimoHijo == -1 )
+        state = COMANDO_ERROR;
+      else
+        trabajos_anyadir_proceso ( trabajo, ultimoHijo, comandos[i].argv[0] );
+
       // Cerramos el pipe en el proceso padre.
-      if ( ( i + 1 ) != info.numProgramas )
+      if ( ( i + 1 ) != numComandos )
       {
-        if ( close ( info.programas[i].pipe_io[1] ) == -1 )
+        if ( close ( estados[i].pipe_io[1] ) == -1 )
         {
           perror ( "close" );
         }
       }
       if ( i > 0 )
       {
-        if ( close ( info.programas[i - 1].pipe_io[0] ) == -1 )
+        if ( close ( estados[i - 1].pipe_io[0] ) == -1 )
         {
           perror ( "close" );
         }
       }
     }
 
-    // Si ejecutamos en modo RUN, esperamos.
-    if ( !info.ejecutarEnSpawn )
+    // Si ejecutamos en modo RUN, esperamos a que termine el trabajo o se
+    // detenga, y guardamos en $? el código de salida del último programa.
+    if ( !tuberia->segundoPlano )
     {
-      pid_t hijoTerminado;
-      int codigoRetorno;
-
-      do
-      {
-        hijoTerminado = wait ( &codigoRetorno );
-
-        // Si ha terminado el ltimo hijo, guardamos su cdigo de retorno
-        // en la variable $?.
-        if ( hijoTerminado == ultimoHijo )
-        {
-          char str [ 8 ];
-          sprintf ( str, "%d", codigoRetorno );
-          variables_establecer ( vars, "?", str );
-        }
-      } while ( hijoTerminado != -1 );
+      int codigo = trabajos_primer_plano ( trabajo, 0 );
+      establecer_codigo_salida ( vars, codigo );
     }
+    else
+    {
+      trabajos_segundo_plano ( trabajo, 0 );
+      establecer_codigo_salida ( vars, 0 );
+    }
+
+    // Si no se ha podido lanzar el último programa, lo indicamos en $? igual
+    // que si hubiese terminado con el código 127.
+    if ( ultimoHijo == -1 )
+      establecer_codigo_salida ( vars, 127 );
   }
 
+  liberar_estados ( estados, numComandos );
   return state;
 }
 
@@ -311,18 +556,299 @@ static CommandState cmdInterno_history ( int argc, char* argv[] )
   return COMANDO_OK;
 }
 
+static CommandState cmdInterno_latency ( int argc, char* argv[] )
+{
+  latencia_mostrar ( 1 );
+  latencia_reiniciar ();
+  return COMANDO_OK;
+}
+
+static CommandState cmdInterno_jobs ( int argc, char* argv[] )
+{
+  trabajos_mostrar ( 1 );
+  return COMANDO_OK;
+}
+
+static CommandState cmdInterno_fg ( int argc, char* argv[] )
+{
+  Trabajo* trabajo = trabajos_buscar ( ( argc > 1 ) ? argv[1] : NULL );
+
+  if ( trabajo == NULL )
+  {
+    writef ( 2, "fg: %s: no existe ese trabajo\n", ( argc > 1 ) ? argv[1] : "actual" );
+    return COMANDO_ERROR;
+  }
+
+  writef ( 1, "%s\n", trabajos_comando ( trabajo ) );
+  codigoComandoInterno = trabajos_primer_plano ( trabajo, 1 );
+  return COMANDO_OK;
+}
+
+static CommandState cmdInterno_bg ( int argc, char* argv[] )
+{
+  Trabajo* trabajo = trabajos_buscar ( ( argc > 1 ) ? argv[1] : NULL );
+
+  if ( trabajo == NULL )
+  {
+    writef ( 2, "bg: %s: no existe ese trabajo\n", ( argc > 1 ) ? argv[1] : "actual" );
+    return COMANDO_ERROR;
+  }
+
+  trabajos_segundo_plano ( trabajo, 1 );
+  return COMANDO_OK;
+}
+
+static const struct
+{
+  const char* nombre;
+  int senyal;
+} senyales [] = {
+  { "HUP", SIGHUP }, { "INT", SIGINT }, { "QUIT", SIGQUIT }, { "KILL", SIGKILL },
+  { "USR1", SIGUSR1 }, { "USR2", SIGUSR2 }, { "PIPE", SIGPIPE }, { "ALRM", SIGALRM },
+  { "TERM", SIGTERM }, { "CHLD", SIGCHLD }, { "CONT", SIGCONT }, { "STOP", SIGSTOP },
+  { "TSTP", SIGTSTP }, { "TTIN", SIGTTIN }, { "TTOU", SIGTTOU }, { "WINCH", SIGWINCH }
+};
+
+// Acepta el número de la señal o su nombre, con o sin el prefijo SIG.
+static int buscar_senyal ( const char* nombre )
+{
+  const char* p;
+  unsigned int i;
+
+  if ( ( nombre[0] >= '0' ) && ( nombre[0] <= '9' ) )
+  {
+    for ( p = nombre; *p != '\0'; ++p )
+    {
+      if ( ( *p < '0' ) || ( *p > '9' ) )
+        return -1;
+    }
+    return ( atoi ( nombre ) < NSIG ) ? atoi ( nombre ) : -1;
+  }
+
+  if ( strncmp ( nombre, "SIG", 3 ) == 0 )
+    nombre += 3;
+  for ( i = 0; i < sizeof(senyales) / sizeof(senyales[0]); ++i )
+  {
+    if ( strcmp ( nombre, senyales[i].nombre ) == 0 )
+      return senyales[i].senyal;
+  }
+
+  return -1;
+}
+
+static CommandState cmdInterno_kill ( int argc, char* argv[] )
+{
+  const char* inicio;
+  const char* p;
+  int senyal = SIGTERM;
+  int fallos = 0;
+  unsigned int j;
+  int i = 1;
+
+  if ( ( argc > 1 ) && ( strcmp ( argv[1], "-l" ) == 0 ) )
+  {
+    for ( j = 0; j < sizeof(senyales) / sizeof(senyales[0]); ++j )
+      writef ( 1, "%2d) SIG%s\n", senyales[j].senyal, senyales[j].nombre );
+    return COMANDO_OK;
+  }
+
+  // La señal se indica con -s SEÑAL, -n SEÑAL o -SEÑAL.
+  if ( ( argc > 2 ) && ( ( strcmp ( argv[1], "-s" ) == 0 ) || ( strcmp ( argv[1], "-n" ) == 0 ) ) )
+  {
+    senyal = buscar_senyal ( argv[2] );
+    i = 3;
+  }
+  else if ( ( argc > 1 ) && ( argv[1][0] == '-' ) && ( argv[1][1] != '\0' ) )
+  {
+    senyal = buscar_senyal ( &(argv[1][1]) );
+    i = 2;
+  }
+
+  if ( senyal == -1 )
+  {
+    writef ( 2, "kill: %s: señal no válida\n", argv[i - 1] );
+    codigoComandoInterno = 2;
+    return COMANDO_ERROR;
+  }
+  if ( i >= argc )
+  {
+    writef ( 2, "uso: kill [-s señal | -señal] pid | %%trabajo ...\n" );
+    codigoComandoInterno = 2;
+    return COMANDO_ERROR;
+  }
+
+  // Los trabajos reciben la señal en todos sus procesos, no sólo en el primero.
+  for ( ; i < argc; ++i )
+  {
+    if ( argv[i][0] == '%' )
+    {
+      Trabajo* trabajo = trabajos_buscar ( argv[i] );
+
+      if ( trabajo == NULL )
+      {
+        writef ( 2, "kill: %s: no existe ese trabajo\n", argv[i] );
+        ++fallos;
+      }
+      else if ( trabajos_senyal ( trabajo, senyal ) == -1 )
+      {
+        writef ( 2, "kill: %s: %s\n", argv[i], strerror ( errno ) );
+        ++fallos;
+      }
+      continue;
+    }
+
+    inicio = ( argv[i][0] == '-' ) ? &(argv[i][1]) : argv[i];
+    for ( p = inicio; *p != '\0'; ++p )
+    {
+      if ( ( *p < '0' ) || ( *p > '9' ) )
+        break;
+    }
+    if ( ( *p != '\0' ) || ( p == inicio ) )
+    {
+      writef ( 2, "kill: %s: pid no válido\n", argv[i] );
+      ++fallos;
+    }
+    else if ( kill ( (pid_t)atoi ( argv[i] ), senyal ) == -1 )
+    {
+      writef ( 2, "kill: %s: %s\n", argv[i], strerror ( errno ) );
+      ++fallos;
+    }
+  }
+
+  return ( fallos > 0 ) ? COMANDO_ERROR : COMANDO_OK;
+}
+
+static CommandState cmdInterno_pipesize ( int argc, char* argv[] )
+{
+  int tamanyo;
+
+  if ( argc < 2 )
+  {
+    tuberias_mostrar ( 1 );
+    return COMANDO_OK;
+  }
+
+  tamanyo = tuberias_interpretar_tamanyo ( argv[1] );
+  if ( tamanyo == -1 )
+  {
+    writef ( 2, "pipesize: %s: tamaño no válido\n", argv[1] );
+    return COMANDO_ERROR;
+  }
+
+  tuberias_establecer_tamanyo ( tamanyo );
+  return COMANDO_OK;
+}
+
+static CommandState cmdInterno_autobatch ( int argc, char* argv[] )
+{
+  if ( argc < 2 )
+  {
+    lotes_mostrar ( 1 );
+    return COMANDO_OK;
+  }
+
+  if ( strcmp ( argv[1], "on" ) == 0 )
+  {
+    lotes_activar ( 1 );
+  }
+  else if ( strcmp ( argv[1], "off" ) == 0 )
+  {
+    lotes_activar ( 0 );
+  }
+  else
+  {
+    writef ( 2, "uso: autobatch [on|off]\n" );
+    codigoComandoInterno = 2;
+    return COMANDO_ERROR;
+  }
+
+  return COMANDO_OK;
+}
+
+static CommandState cmdInterno_highlight ( int argc, char* argv[] )
+{
+  if ( argc < 2 )
+  {
+    writef ( 1, "highlight: %s\n", resaltado_activado () ? "on" : "off" );
+    return COMANDO_OK;
+  }
+
+  if ( strcmp ( argv[1], "on" ) == 0 )
+  {
+    resaltado_activar ( 1 );
+  }
+  else if ( strcmp ( argv[1], "off" ) == 0 )
+  {
+    resaltado_activar ( 0 );
+  }
+  else
+  {
+    writef ( 2, "uso: highlight [on|off]\n" );
+    codigoComandoInterno = 2;
+    return COMANDO_ERROR;
+  }
+
+  return COMANDO_OK;
+}
+
+static CommandState cmdInterno_parallel ( int argc, char* argv[] )
+{
+  int codigo = paralelo_ejecutar ( argc, argv );
+
+  if ( codigo == -1 )
+  {
+    codigoComandoInterno = 2;
+    return COMANDO_ERROR;
+  }
+
+  codigoComandoInterno = codigo;
+  return ( codigo == 0 ) ? COMANDO_OK : COMANDO_ERROR;
+}
+
+static CommandState cmdInterno_hash ( int argc, char* argv[] )
+{
+  Rutas* rutas = rutas_obtener_instancia ();
+  CommandState estado = COMANDO_OK;
+  int i;
+
+  if ( argc < 2 )
+  {
+    rutas_mostrar ( rutas, 1 );
+    return COMANDO_OK;
+  }
+
+  if ( strcmp ( argv[1], "-r" ) == 0 )
+  {
+    rutas_vaciar ( rutas );
+    return COMANDO_OK;
+  }
+
+  // Volvemos a buscar en el PATH los programas indicados.
+  for ( i = 1; i < argc; ++i )
+  {
+    rutas_olvidar ( rutas, argv[i] );
+    if ( rutas_buscar ( rutas, argv[i] ) == NULL )
+    {
+      writef ( 2, "hash: %s: no encontrado\n", argv[i] );
+      estado = COMANDO_ERROR;
+    }
+  }
+
+  return estado;
+}
+
 static CommandState cmdInterno_cd ( int argc, char* argv[] )
 {
   char cwd [ 256 ];
   struct stat estado;
 
-  // Si no especifican un parmetro, nos vamos al HOME.
+  // Si no especifican un parámetro, nos vamos al HOME.
   if ( argc < 2 )
   {
     const char* destino = getenv ( "HOME" );
     if ( destino == NULL )
     {
-      write ( 2, "cd: Nmero de parmetros incorrecto.\n", 37 );
+      write ( 2, "cd: Número de parámetros incorrecto.\n", 37 );
       return COMANDO_ERROR;
     }
     else
@@ -402,19 +928,21 @@ static CommandState cmdInterno_alias ( int argc, char* argv[] )
     }
     else
     {
-      // Volcamos todos los parmetros a una cadena.
-      char linea [ 256 ];
+      // Volcamos todos los parámetros a una cadena.
+      Cadena cadena;
+      char* linea;
       int i;
 
-      linea[0] = '\0';
+      cadena_inicializar ( &cadena );
       for ( i = 1; i < argc; ++i )
       {
-        strcat ( linea, argv[i] );
+        cadena_anyadir ( &cadena, argv[i] );
         if ( i < ( argc - 1 ) )
         {
-          strcat ( linea, " ");
+          cadena_anyadir ( &cadena, " ");
         }
       }
+      linea = cadena.datos;
       p = strchr ( linea, '=' );
 
       // Generamos un nuevo alias.
@@ -433,6 +961,7 @@ static CommandState cmdInterno_alias ( int argc, char* argv[] )
       }
 
       aliases_establecer ( aliases, linea, p );
+      cadena_liberar ( &cadena );
     }
   }
 
@@ -445,7 +974,7 @@ static CommandState cmdInterno_unalias ( int argc, char* argv[] )
 
   if ( argc < 2 )
   {
-    write ( 2, "unalias: Se requiere un parmetro.\n", 35 );
+    write ( 2, "unalias: Se requiere un parámetro.\n", 35 );
     return COMANDO_ERROR;
   }
 
@@ -461,5 +990,15 @@ void registrar_comandos_internos ()
   anyadirComandoInterno ( "cd", cmdInterno_cd );
   anyadirComandoInterno ( "alias", cmdInterno_alias );
   anyadirComandoInterno ( "unalias", cmdInterno_unalias );
+  anyadirComandoInterno ( "latency", cmdInterno_latency );
+  anyadirComandoInterno ( "hash", cmdInterno_hash );
+  anyadirComandoInterno ( "jobs", cmdInterno_jobs );
+  anyadirComandoInterno ( "fg", cmdInterno_fg );
+  anyadirComandoInterno ( "bg", cmdInterno_bg );
+  anyadirComandoInterno ( "kill", cmdInterno_kill );
+  anyadirComandoInterno ( "pipesize", cmdInterno_pipesize );
+  anyadirComandoInterno ( "parallel", cmdInterno_parallel );
+  anyadirComandoInterno ( "autobatch", cmdInterno_autobatch );
+  anyadirComandoInterno ( "highlight", cmdInterno_highlight );
 }
 
@@ -27,16 +27,17 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       comandos.h
- * DESCRIPCIN:   Ejecucin de los comandos introducidos y comandos internos.
+ * DESCRIPCIÓN:   Ejecución de los comandos introducidos y comandos internos.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #pragma once
 
 #include "aliases.h"
+#include "documentos.h"
 #include "historial.h"
 #include "variables.h"
 
@@ -48,6 +49,8 @@ typedef enum
   COMANDO_SALIR
 } CommandState;
 
-CommandState procesar_comando ( char* linea, char* envp[], Variables* vars, Aliases* aliases );
+// Los cuerpos de los here-documents de la linea, ya leídos, van en docs
+// (puede ser NULL si no hay ninguno).
+CommandState procesar_comando ( char* linea, char* envp[], Variables* vars, Aliases* aliases, Documentos* docs );
 void registrar_comandos_internos ();
 int es_comando_interno ( const char* comando );
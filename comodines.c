@@ -27,11 +27,11 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       comodines.c
- * DESCRIPCIN:   Comodines y sugerencias.
+ * DESCRIPCIÓN:   Comodines y sugerencias.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #include <assert.h>
@@ -44,37 +44,37 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include "arena.h"
+#include "cadena.h"
 #include "comodines.h"
-#include "infolinea.h"
+#include "eventos.h"
 #include "io.h"
-#include "match.h"
+#include "lexico.h"
+#include "patron.h"
 #include "terminal.h"
 
 typedef struct _ListaSugerencias
 {
-  char sugerencia [ 256 ];
+  char* sugerencia;
   int esDirectorio;
+  int expandido;                // Caracteres del comienzo que ya son nombres encontrados.
   struct _ListaSugerencias* siguiente;
   struct _ListaSugerencias* anterior;
 } ListaSugerencias;
 
 static void rellenar_en_cursor_con_sugerencia ( Linea* linea, const char* sugerencia, int esDefinitiva );
 
-static void eliminar_lista_sugerencias ( ListaSugerencias* lista )
+// Los nodos y su texto salen de la arena, y se liberan todos juntos al
+// vaciarla.
+static ListaSugerencias* crear_nodo_sugerencias ( Arena* arena, char* sugerencia, int esDirectorio, int expandido )
 {
-  ListaSugerencias* siguiente;
-  for ( ; lista != NULL; lista = siguiente )
-  {
-    siguiente = lista->siguiente;
-    free ( lista );
-  }
-}
+  ListaSugerencias* nodo = (ListaSugerencias *)arena_reservar ( arena, sizeof(ListaSugerencias) );
 
-static ListaSugerencias* crear_nodo_sugerencias ( char* sugerencia, int esDirectorio )
-{
-  ListaSugerencias* nodo = (ListaSugerencias *)malloc(sizeof(ListaSugerencias));
+  // Dejamos sitio para la / que se añade a los directorios al completarlos.
+  nodo->sugerencia = (char *)arena_reservar ( arena, strlen ( sugerencia ) + 2 );
   strcpy ( nodo->sugerencia, sugerencia );
   nodo->esDirectorio = esDirectorio;
+  nodo->expandido = expandido;
   nodo->siguiente = NULL;
   nodo->anterior = NULL;
 
@@ -98,7 +98,7 @@ static void ordenar_lista_sugerencias ( ListaSugerencias** primero, int tamanyoL
       {
         siguiente = actual->siguiente;
 
-        // Si el nodo actual es mayor que el siguiente, muvelo una posicin hacia delante.
+        // Si el nodo actual es mayor que el siguiente, muévelo una posición hacia delante.
         if ( strcmp ( actual->sugerencia, siguiente->sugerencia ) > 0 )
         {
           // Marca la lista como no ordenada.
@@ -115,7 +115,7 @@ static void ordenar_lista_sugerencias ( ListaSugerencias** primero, int tamanyoL
           if ( anterior != NULL )
             anterior->siguiente = siguiente;
 
-          // Reenlzalo despus del siguiente.
+          // Reenlázalo después del siguiente.
           if ( siguiente->siguiente != NULL )
             siguiente->siguiente->anterior = actual;
           actual->siguiente = siguiente->siguiente;
@@ -134,7 +134,7 @@ static void ordenar_lista_sugerencias ( ListaSugerencias** primero, int tamanyoL
 
 static int sugerencias_comienzan_igual ( ListaSugerencias* lista, char* comienzo )
 {
-  // Primero comprobamos cunto coinciden la primera y la segunda sugerencia.
+  // Primero comprobamos cuánto coinciden la primera y la segunda sugerencia.
   int coincidencia = 0;
   char* primera = lista->sugerencia;
   char* segunda = lista->siguiente->sugerencia;
@@ -156,7 +156,7 @@ static int sugerencias_comienzan_igual ( ListaSugerencias* lista, char* comienzo
   strncpy ( comienzo, lista->sugerencia, coincidencia );
   comienzo [ coincidencia ] = '\0';
 
-  // Verificamos si pasa lo mismo con las dems.
+  // Verificamos si pasa lo mismo con las demás.
   for ( lista = lista->siguiente->siguiente; lista != NULL; lista = lista->siguiente )
   {
     if ( strncmp ( lista->sugerencia, comienzo, coincidencia ) != 0 )
@@ -172,38 +172,48 @@ static int sugerencias_comienzan_igual ( ListaSugerencias* lista, char* comienzo
 
 
 
-static int buscar_entradas_sugeridas ( char* argumento, int esEjecutable, ListaSugerencias** sugerencias )
+// Las rutas se construyen en la arena con el tamaño justo, así que no hay
+// límite para la longitud de los nombres ni del PATH.
+static char* unir_ruta ( Arena* arena, const char* ruta, const char* nombre, const char* resto )
+{
+  char* texto = (char *)arena_reservar ( arena, strlen ( ruta ) + strlen ( nombre ) + strlen ( resto ) + 1 );
+
+  strcpy ( texto, ruta );
+  strcat ( texto, nombre );
+  strcat ( texto, resto );
+  return texto;
+}
+
+static int buscar_entradas_sugeridas ( Arena* arena, char* argumento, int esEjecutable, ListaSugerencias** sugerencias )
 {
   char* p;
   char* comodin;
-  char* comodin2;
   int hayComodines;
   int numSugerencias = 0;
   int rutasCompletas = 1;
-  char nuevaRuta [ 256 ];
 
   // Si no nos dan un lugar en el que guardar las sugerencias, simplemente finalizamos.
   if ( sugerencias == NULL )
     return 0;
   *sugerencias = NULL;
 
-  // Creamos el primer nodo, y le asignamos el patrn tal cual, que se ir expandiendo
+  // Creamos el primer nodo, y le asignamos el patrón tal cual, que se irá expandiendo
   // con el siguiente bucle. En caso de ser un ejecutable, comprobamos primero si nos
-  // estn intentando dar una ruta (buscando el caracter '/'). De no ser as, agregamos
+  // están intentando dar una ruta (buscando el caracter '/'). De no ser así, agregamos
   // una entrada por cada entrada del PATH y exigimos rutas no completas.
   ListaSugerencias* lista;
 
   if ( !esEjecutable || ( strchr ( argumento, '/' ) != NULL ) )
   {
-    lista = crear_nodo_sugerencias ( argumento, 0 );
+    lista = crear_nodo_sugerencias ( arena, argumento, 0, 0 );
     *sugerencias = lista;
     numSugerencias++;
   }
   else
   {
-    // Aadimos una entrada por cada entrada del PATH.
+    // Añadimos una entrada por cada entrada del PATH.
     const char* PATH = getenv("PATH");
-    char path [ 256 ];
+    char* path;
     int continuar = 1;
     char* pathActual;
     char* pathSiguiente;
@@ -214,7 +224,7 @@ static int buscar_entradas_sugeridas ( char* argumento, int esEjecutable, ListaS
       return 0;
 
     // Hacemos una copia para poder modificarla.
-    strcpy ( path, PATH );
+    path = arena_strdup ( arena, PATH );
     pathSiguiente = path;
 
     // Iteramos por los directorios del PATH.
@@ -242,8 +252,7 @@ static int buscar_entradas_sugeridas ( char* argumento, int esEjecutable, ListaS
       }
 
       // Agregamos el nodo a la lista con este PATH.
-      sprintf ( nuevaRuta, "%s/%s", pathActual, argumento );
-      lista = crear_nodo_sugerencias ( nuevaRuta, 0 );
+      lista = crear_nodo_sugerencias ( arena, unir_ruta ( arena, pathActual, "/", argumento ), 0, 0 );
       if ( *sugerencias == NULL )
       {
         *sugerencias = lista;
@@ -268,39 +277,34 @@ static int buscar_entradas_sugeridas ( char* argumento, int esEjecutable, ListaS
   ListaSugerencias* actual;
   do
   {
-    char ruta [ 256 ];
-    char rutaDespues [ 256 ];
-    char sugerencia [ 256 ];
+    char* ruta;
+    const char* rutaDespues;
+    char* sugerencia;
     ListaSugerencias* nuevaSugerencia;
 
-    // Buscamos comodines en el primer elemento de la lista.
+    // Buscamos comodines en el primer elemento de la lista. Los nombres ya
+    // encontrados no se vuelven a tomar como patrón aunque tengan * o [.
     actual = *sugerencias;
-    comodin = strchr ( actual->sugerencia, '*' );
-    comodin2 = strchr ( actual->sugerencia, '?' );
-    hayComodines = ( comodin != NULL ) || ( comodin2 != NULL );
+    comodin = patron_buscar_comodin ( &(actual->sugerencia [ actual->expandido ]) );
+    hayComodines = ( comodin != NULL );
 
     if ( hayComodines )
     {
-      // Si an quedan comodines por procesar, los procesamos para cada elemento de la lista.
+      // Si aún quedan comodines por procesar, los procesamos para cada elemento de la lista.
       do
       {
         ListaSugerencias* siguiente = actual->siguiente;
         ListaSugerencias* ultimaSugerenciaCreada = NULL;
+        Patron* patron;
 
-        // Cogemos el comodn que antes est.
-        if ( comodin == NULL )
-          comodin = comodin2;
-        else if ( ( comodin2 != NULL ) && ( comodin2 < comodin ) )
-          comodin = comodin2;
-
-        // En este punto debera haber siempre un comodn en el patrn.
+        // En este punto debería haber siempre un comodín en el patrón.
         assert ( comodin != NULL );
 
 
 
 
 
-        // Buscamos la ruta que haya antes del comodn.
+        // Buscamos la ruta que haya antes del comodín.
         p = comodin - 1;
         while ( ( p > actual->sugerencia ) && ( *p != '/' ) )
           --p;
@@ -309,45 +313,44 @@ static int buscar_entradas_sugeridas ( char* argumento, int esEjecutable, ListaS
           // Caso especial: la sugerencia es /*
           if ( ( p == actual->sugerencia ) && ( *p == '/' ) )
           {
-            strcpy ( ruta, "/" );
+            ruta = arena_strdup ( arena, "/" );
           }
           else
           {
             // Es el principio de la ruta.
-            ruta[0] = '\0';
+            ruta = arena_strdup ( arena, "" );
           }
         }
         else
         {
-          strncpy ( ruta, actual->sugerencia, p - actual->sugerencia + 1 );
-          ruta [ p - actual->sugerencia + 1 ] = '\0';
+          ruta = arena_strndup ( arena, actual->sugerencia, p - actual->sugerencia + 1 );
         }
 
-        // Buscamos la ruta que hay despus del comodn.
+        // Buscamos la ruta que hay después del comodín.
         p = strchr ( comodin, '/' );
         if ( p == NULL )
         {
           // Es el final de la ruta.
-          rutaDespues[0] = '\0';
+          rutaDespues = "";
         }
         else
         {
-          strcpy ( rutaDespues, p );
+          rutaDespues = p;
         }
 
-        // Cogemos el patrn a procesar.
+        // Cogemos el patrón a procesar.
         int len = strlen ( actual->sugerencia ) - strlen ( ruta ) - strlen ( rutaDespues );
-        strncpy ( sugerencia, &( actual->sugerencia [ strlen ( ruta ) ] ), len );
-        sugerencia [ len ] = '\0';
+        sugerencia = arena_strndup ( arena, &( actual->sugerencia [ strlen ( ruta ) ] ), len );
+        patron = patron_compilar ( arena, sugerencia );
 
 
 
 
 
         // En este punto tenemos las siguientes variables:
-        // - ruta: La ruta antes del patrn a buscar.
-        // - sugerencia: El patrn a buscar.
-        // - rutaDespues: La ruta despus del patrn a buscar.
+        // - ruta: La ruta antes del patrón a buscar.
+        // - sugerencia: El patrón a buscar.
+        // - rutaDespues: La ruta después del patrón a buscar.
         // Abrimos el directorio para buscar las entradas con la ruta dada.
         DIR* dir;
         struct dirent* entry;
@@ -360,33 +363,38 @@ static int buscar_entradas_sugeridas ( char* argumento, int esEjecutable, ListaS
           dir = opendir ( ruta );
         }
 
-        // No nos interesa abortar la ejecucin si no se encuentra el directorio,
-        // ya que se espera que todos los directorios que aparezcan aqu hayan sido
+        // No nos interesa abortar la ejecución si no se encuentra el directorio,
+        // ya que se espera que todos los directorios que aparezcan aquí hayan sido
         // procesados antes, que el usuario haya dado un directorio inexistente o
         // que uno de los directorios del PATH no exista.
         if ( dir != NULL )
         {
           for ( entry = readdir ( dir ); entry != NULL; entry = readdir ( dir ) )
           {
-            char rutaParcial [ 256 ];
             struct stat estado;
             int esValido = 1;
 
-            // Ignoramos ficheros oculto si no estn pidiendo un fichero oculto.
+            // Ignoramos ficheros oculto si no están pidiendo un fichero oculto.
             if ( ( sugerencia[0] != '.' ) && ( entry->d_name[0] == '.' ) )
             {
               esValido = 0;
             }
 
+            // Comprobamos que coincida con el patrón antes de nada más, ya que
+            // en directorios grandes casi ninguna entrada coincide.
+            if ( esValido && !patron_coincide ( patron, entry->d_name ) )
+            {
+              esValido = 0;
+            }
+
             // Extraemos el estado de la entrada.
             if ( esValido )
             {
-              sprintf ( rutaParcial, "%s%s", ruta, entry->d_name );
-              if ( stat ( rutaParcial, &estado ) == -1 )
+              if ( stat ( unir_ruta ( arena, ruta, entry->d_name, "" ), &estado ) == -1 )
                 esValido = 0;
             }
 
-            // Si hay una ruta despus del patrn, slo buscamos directorios.
+            // Si hay una ruta después del patrón, sólo buscamos directorios.
             if ( esValido && ( rutaDespues[0] != '\0' ) )
             {
               if ( ! S_ISDIR ( estado.st_mode ) )
@@ -395,12 +403,6 @@ static int buscar_entradas_sugeridas ( char* argumento, int esEjecutable, ListaS
               }
             }
 
-            // Comprobamos que coincida con el patrn.
-            if ( esValido && ( match ( sugerencia, entry->d_name ) != 0 ) )
-            {
-              esValido = 0;
-            }
-
             // Comprobamos que sea un fichero regular y ejecutable.
             if ( esValido && esEjecutable && ( rutaDespues[0] == '\0' ) )
             {
@@ -422,12 +424,14 @@ static int buscar_entradas_sugeridas ( char* argumento, int esEjecutable, ListaS
               // Como hay coincidencia, creamos un nuevo nodo en la lista con esta entrada.
               if ( rutasCompletas )
               {
-                sprintf ( nuevaRuta, "%s%s%s", ruta, entry->d_name, rutaDespues );
-                nuevaSugerencia = crear_nodo_sugerencias ( nuevaRuta, S_ISDIR ( estado.st_mode ) );
+                nuevaSugerencia = crear_nodo_sugerencias ( arena, unir_ruta ( arena, ruta, entry->d_name, rutaDespues ),
+                                                           S_ISDIR ( estado.st_mode ),
+                                                           strlen ( ruta ) + strlen ( entry->d_name ) );
               }
               else
               {
-                nuevaSugerencia = crear_nodo_sugerencias ( entry->d_name, S_ISDIR ( estado.st_mode ) );
+                nuevaSugerencia = crear_nodo_sugerencias ( arena, entry->d_name, S_ISDIR ( estado.st_mode ),
+                                                           strlen ( entry->d_name ) );
               }
 
               if ( ultimaSugerenciaCreada == NULL )
@@ -459,23 +463,19 @@ static int buscar_entradas_sugeridas ( char* argumento, int esEjecutable, ListaS
 
         // Pasamos al siguiente elemento de la lista y volvemos a procesar, desligando este
         // nodo de la lista. Se asume que el nodo actual ya ha sido reemplazado con las
-        // entradas que cumplan el patrn.
+        // entradas que cumplían el patrón.
         if ( actual == *sugerencias )
           *sugerencias = actual->siguiente;
         if ( actual->anterior )
           actual->anterior->siguiente = actual->siguiente;
         if ( actual->siguiente )
           actual->siguiente->anterior = actual->anterior;
-        free ( actual );
         actual = siguiente;
         --numSugerencias;
 
-        // Buscamos la posicin de los comodines del siguiente.
+        // Buscamos la posición de los comodines del siguiente.
         if ( actual != NULL )
-        {
-          comodin = strchr ( actual->sugerencia, '*' );
-          comodin2 = strchr ( actual->sugerencia, '?' );
-        }
+          comodin = patron_buscar_comodin ( &(actual->sugerencia [ actual->expandido ]) );
       } while ( actual != NULL );
     }
   } while ( ( hayComodines ) && ( *sugerencias != NULL ) );
@@ -492,61 +492,50 @@ void procesar_sugerencias ( Linea* linea_ )
   int argumentoContieneComodines = 0;
   char argumentoOriginal [ 256 ];
   char argumento [ 256 ];
-  int esNuevoArgumentoSugerido = 0;
+  int inicio;
+  int fin;
   ListaSugerencias* sugerencias;
-
-  // Copiamos la linea para no alterarla en el procesado.
-  char linea [ MAX_LINEA ];
-  strcpy ( linea, linea_hacer_string ( linea_ ) );
+  static Arena arena;
 
   // Casos a evitar:
-  // - El cursor est al principio, la lnea no est vaca y en el cursor hay un espacio.
-  if ( ( linea_->cursor == 0 ) && ( linea_->len > 0 ) && ( linea_->buffer[0] == ' ' ) )
+  // - El cursor está al principio, la línea no está vacía y en el cursor hay un espacio.
+  if ( ( linea_->cursor == 0 ) && ( linea_->len > 0 ) && ( linea_caracter ( linea_, 0 ) == ' ' ) )
   {
     return;
   }
 
-  // - El cursor est en un espacio, y a su izquierda hay un espacio.
-  if ( ( linea_->cursor > 0 ) && ( linea_->buffer[linea_->cursor] == ' ' ) &&
-       ( linea_->buffer[linea_->cursor - 1] == ' ' ) )
+  // - El cursor está en un espacio, y a su izquierda hay un espacio.
+  if ( ( linea_->cursor > 0 ) && ( linea_->cursor < linea_->len ) &&
+       ( linea_caracter ( linea_, linea_->cursor ) == ' ' ) &&
+       ( linea_caracter ( linea_, linea_->cursor - 1 ) == ' ' ) )
   {
     return;
   }
 
-  // Comprobamos si estn intentando generar un nuevo argumento mediante sugerencias.
-  // El cursor est al final, y a su izquierda hay un espacio.
-  if ( ( linea_->cursor == linea_->len ) && ( linea_->len > 0 ) &&
-       ( linea_->buffer[linea_->cursor - 1] == ' ' ) )
-  {
-    esNuevoArgumentoSugerido = 1;
-  }
-
-
-  // Procesamos la linea.
-  InfoLinea info;
-  InfoLineaCursor infoCursor;
-  infolinea_procesar ( &info, linea, &infoCursor, linea_->cursor );
-
-  // Comprobamos si el argumento es un ejecutable.
-  argumentoEsEjecutable = ( ( infoCursor.argumento == 0 ) || ( info.numProgramas == 0 ) ) && !esNuevoArgumentoSugerido;
-
-  // Obtenemos el argumento.
-  if ( ( info.numProgramas == 0 ) || esNuevoArgumentoSugerido )
+  // Los tokens de la linea dicen qué palabra hay en el cursor y si es el
+  // nombre de un programa. Si no hay ninguna, se sugiere un argumento nuevo.
+  if ( !lexico_palabra ( &(linea_->lexico), linea_->cursor, &inicio, &fin, &argumentoEsEjecutable ) )
   {
+    argumentoEsEjecutable = lexico_es_comando ( &(linea_->lexico), linea_->cursor );
     strcpy ( argumento, "*" );
   }
   else
   {
     int len;
-    strcpy ( argumento, info.programas [ infoCursor.programa ].argv [ infoCursor.argumento ] );
+
+    // No buscamos sugerencias para argumentos que no caben en una ruta.
+    if ( ( fin - inicio ) >= ( sizeof(argumento) - 1 ) )
+      return;
+    linea_copiar ( linea_, inicio, fin, argumento );
+    argumento [ fin - inicio ] = '\0';
     strcpy ( argumentoOriginal, argumento );
 
-    if ( ( strchr ( argumento, '*' ) != NULL ) || ( strchr ( argumento, '?' ) != NULL ) )
+    if ( patron_buscar_comodin ( argumento ) != NULL )
     {
       argumentoContieneComodines = 1;
     }
 
-    // Si el ltimo caracter no es un comodn, aadimos un '*'.
+    // Si el último caracter no es un comodín, añadimos un '*'.
     len = strlen ( argumento );
     if ( len > 0 )
     {
@@ -565,15 +554,12 @@ void procesar_sugerencias ( Linea* linea_ )
       strcpy ( argumento, "*" );
   }
 
-  // Eliminamos comodines superfluos.
-  collapse ( argumento );
-
   // Buscamos las sugerencias
-  int numSugerencias = buscar_entradas_sugeridas ( argumento, argumentoEsEjecutable, &sugerencias );
+  int numSugerencias = buscar_entradas_sugeridas ( &arena, argumento, argumentoEsEjecutable, &sugerencias );
   if ( numSugerencias == 1 )
   {
-    // Si slo tenemos una sugerencia, lo sustitumos dirctamente en la linea.
-    // En caso de ser un directorio, no se considera definitiva y se aade la / final.
+    // Si sólo tenemos una sugerencia, lo sustituímos diréctamente en la linea.
+    // En caso de ser un directorio, no se considera definitiva y se añade la / final.
     if ( sugerencias->esDirectorio == 1 )
     {
       if ( sugerencias->sugerencia [ strlen ( sugerencias->sugerencia ) - 1 ] != '/' )
@@ -589,14 +575,14 @@ void procesar_sugerencias ( Linea* linea_ )
   }
   else if ( numSugerencias > 1 )
   {
-    // En caso de tener ms de una sugerencia, las mostramos por pantalla.
+    // En caso de tener más de una sugerencia, las mostramos por pantalla.
     int i;
     int continuar = 1;
 
-    // Si todas las sugerencias empiezan igual, el argumento no tena comodines,
+    // Si todas las sugerencias empiezan igual, el argumento no tenía comodines,
     // y el comienzo de las sugerencias es distinto al argumento, autocompletamos
     // la parte coincidente.
-    char comienzo_comun [ 256 ];
+    char* comienzo_comun = (char *)arena_reservar ( &arena, strlen ( sugerencias->sugerencia ) + 1 );
     if ( !argumentoContieneComodines &&
          sugerencias_comienzan_igual ( sugerencias, comienzo_comun ) &&
          ( strcmp ( comienzo_comun, argumentoOriginal ) != 0 ) )
@@ -606,38 +592,34 @@ void procesar_sugerencias ( Linea* linea_ )
     else
     {
       ordenar_lista_sugerencias ( &sugerencias, numSugerencias );
-      writef ( 1, "\n" );
-
-      // Evitamos que cancelen el listado con un CTRL+C
-      void (*prevHandler)(int) = signal ( SIGINT, SIG_IGN );
+      salida_escribir ( "\n", 1 );
 
       for ( i = 0; continuar && ( sugerencias != NULL ); sugerencias = sugerencias->siguiente, ++i )
       {
-        writef ( 1, "%s\n", sugerencias->sugerencia );
+        salida_escribirf ( "%s\n", sugerencias->sugerencia );
         if ( ( i != 0 ) && ( ( i % 25 ) == 0 ) && ( sugerencias->siguiente != NULL ) )
         {
           // Cada N sugerencias, interrumpimos a la espera de que pida continuar.
-          writef ( 1, "--- Pulsa q para parar el listado, cualquier otra tecla para continuar ---" );
+          salida_escribirf ( "--- Pulsa q para parar el listado, cualquier otra tecla para continuar ---" );
           char c;
           if ( getch ( &c ) != 1 )
             continuar = 0;
           else if ( c == 'q' )
             continuar = 0;
-          writef ( 1, "\r" );
+          salida_escribir ( "\r", 1 );
           ejecutar_secuencia_escape ( LINEA_LIMPIAR_DERECHA );
         }
       }
 
       linea_mostrar_reset ( linea_ );
 
-      // Restauramos el manejador del SIGINT.
-      signal ( SIGINT, prevHandler );
+      // Evitamos que un CTRL+C durante el listado cancele la linea.
+      eventos_descartar_senyal ( SIGINT );
     }
   }
 
   // Eliminamos la lista de memoria.
-  if ( sugerencias )
-    eliminar_lista_sugerencias ( sugerencias );
+  arena_vaciar ( &arena );
 }
 
 
@@ -649,18 +631,19 @@ static void rellenar_en_cursor_con_sugerencia ( Linea* linea, const char* sugere
   int nuevoCursor;
 
   char* p;
+  char* buffer = linea_hacer_string ( linea );
 
   // Si han hecho solicitado sugerencias desde el espacio que procede
   // al argumento, decrementamos el cursor.
-  if ( ( linea->cursor > 0 ) && ( linea->cursor < linea->len ) && ( linea->buffer [ linea->cursor ] == ' ' ) )
+  if ( ( linea->cursor > 0 ) && ( linea->cursor < linea->len ) && ( buffer [ linea->cursor ] == ' ' ) )
   {
     linea->cursor--;
   }
 
   // Buscamos el comienzo del argumento.
   char* comienzoArgumento;
-  for ( p = &(linea->buffer [ linea->cursor ] );
-        ( p > linea->buffer ) && ( *p != ' ' );
+  for ( p = &(buffer [ linea->cursor ] );
+        ( p > buffer ) && ( *p != ' ' );
         --p );
   comienzoArgumento = p;
   if ( *comienzoArgumento == ' ' )
@@ -668,14 +651,14 @@ static void rellenar_en_cursor_con_sugerencia ( Linea* linea, const char* sugere
 
   // Buscamos el final del argumento
   char* finalArgumento;
-  for ( p = &(linea->buffer [ linea->cursor ] );
+  for ( p = &(buffer [ linea->cursor ] );
         ( *p != '\0' ) && ( *p != ' ' );
         ++p );
   finalArgumento = p;
 
   // Copiamos la linea hasta el argumento.
-  int len = comienzoArgumento - linea->buffer;
-  strncpy ( nuevaLinea, linea->buffer, len );
+  int len = comienzoArgumento - buffer;
+  strncpy ( nuevaLinea, buffer, len );
 
   // Copiamos la sugerencia.
   int sugerenciaLen = strlen(sugerencia);
@@ -694,7 +677,6 @@ static void rellenar_en_cursor_con_sugerencia ( Linea* linea, const char* sugere
   // Modificamos la linea.
   linea_cargar_contenido ( linea, nuevaLinea );
   linea->cursor = nuevoCursor;
-  linea_mostrar_reset ( linea );
 
   free ( nuevaLinea );
 }
@@ -703,92 +685,93 @@ static void rellenar_en_cursor_con_sugerencia ( Linea* linea, const char* sugere
 
 
 
-char* reemplazar_comodines ( char* linea, char* nuevaLinea )
+static void anyadir_campo ( Comando* comando, Cadena* campo, int hayComodines, Arena* arena )
 {
-  // Primero comprobamos si hay algn comodn.
-  int hayComodines = ( strchr ( linea, '*' ) != NULL ) || ( strchr ( linea, '?' ) != NULL );
-  if ( !hayComodines )
-  {
-    return linea;
-  }
+  ListaSugerencias* sugerencias = NULL;
+  ListaSugerencias* actual;
+  int numSugerencias = 0;
 
-  // Procesamos la linea primero.
-  InfoLinea info;
-  infolinea_procesar ( &info, linea, NULL, -1 );
+  // Los campos con comodines se sustituyen por las entradas que encajen, o
+  // se dejan tal cual si no encaja ninguna.
+  if ( hayComodines && ( patron_buscar_comodin ( campo->datos ) != NULL ) )
+    numSugerencias = buscar_entradas_sugeridas ( arena, campo->datos, ( comando->argc == 0 ), &sugerencias );
 
-  if ( info.numProgramas > 0 )
+  // Las entradas encontradas ya están en la arena, y sirven como argumentos.
+  if ( numSugerencias == 0 )
   {
-    int i;
-    int j;
-
-    // Inicializamos la nueva linea.
-    nuevaLinea[0] = '\0';
+    analizador_anyadir_argumento ( arena, comando, arena_strndup ( arena, campo->datos, campo->len ) );
+  }
+  else
+  {
+    int inicio = comando->argc;
 
-    for ( i = 0; i < info.numProgramas; ++i )
+    for ( actual = sugerencias; actual != NULL; actual = actual->siguiente )
+      analizador_anyadir_argumento ( arena, comando, actual->sugerencia );
+    if ( comando->argc - inicio > comando->numComodin )
     {
-      for ( j = 0; j < info.programas[i].argc; ++j )
-      {
-        char* arg = info.programas[i].argv[j];
-        hayComodines = ( strchr ( arg, '*' ) != NULL ) || ( strchr ( arg, '?' ) != NULL );
+      comando->inicioComodin = inicio;
+      comando->numComodin = comando->argc - inicio;
+    }
+  }
 
-        if ( hayComodines )
-        {
-          ListaSugerencias* sugerencias;
-          int numSugerencias = buscar_entradas_sugeridas ( arg, (j == 0), &sugerencias );
-          if ( numSugerencias == 0 )
-          {
-            strcat ( nuevaLinea, arg );
-            strcat ( nuevaLinea, " " );
-          }
-          else
-          {
-            ListaSugerencias* actual;
-            for ( actual = sugerencias; actual != NULL; actual = actual->siguiente )
-            {
-              strcat ( nuevaLinea, actual->sugerencia );
-              strcat ( nuevaLinea, " " );
-            }
-          }
+  cadena_vaciar ( campo );
+}
 
-          if ( sugerencias )
-            eliminar_lista_sugerencias ( sugerencias );
-        }
-        else
-        {
-          strcat ( nuevaLinea, arg );
-          strcat ( nuevaLinea, " " );
-        }
-      }
+static void expandir_palabra ( Comando* comando, Palabra* palabra, Cadena* campo, Arena* arena )
+{
+  int hayCampo = 0;
+  int hayComodines = 0;
+  int i;
 
-      if ( i < ( info.numProgramas - 1 ) )
-      {
-        strcat ( nuevaLinea, "| " );
-      }
+  for ( i = 0; i < palabra->numPartes; ++i )
+  {
+    PartePalabra* parte = &(palabra->partes[i]);
+    const char* p;
+
+    if ( parte->entreComillas )
+    {
+      cadena_anyadir ( campo, parte->texto );
+      hayCampo = 1;
+      continue;
     }
 
-    if ( info.ficheroSalida[0] != '\0' )
+    // El resultado de una expansión sin comillas se parte en los blancos.
+    for ( p = parte->texto; *p != '\0'; ++p )
     {
-      if ( info.salidaAgregada )
+      if ( parte->expandida && ( ( *p == ' ' ) || ( *p == '\t' ) || ( *p == '\n' ) ) )
       {
-        strcat ( nuevaLinea, ">>" );
+        if ( hayCampo )
+          anyadir_campo ( comando, campo, hayComodines, arena );
+        hayCampo = 0;
+        hayComodines = 0;
       }
       else
       {
-        strcat ( nuevaLinea, ">" );
+        cadena_anyadir_caracter ( campo, *p );
+        hayCampo = 1;
+        if ( ( *p == '*' ) || ( *p == '?' ) || ( *p == '[' ) )
+          hayComodines = 1;
       }
-      strcat ( nuevaLinea, info.ficheroSalida );
-      strcat ( nuevaLinea, " ");
     }
-    if ( info.ejecutarEnSpawn )
-    {
-      strcat ( nuevaLinea, "& " );
-    }
-
-    return nuevaLinea;
   }
-  else
+
+  if ( hayCampo )
+    anyadir_campo ( comando, campo, hayComodines, arena );
+}
+
+void comodines_expandir ( Tuberia* tuberia, Arena* arena )
+{
+  static Cadena campo;
+  int i;
+  int j;
+
+  // El campo en construcción se reutiliza entre comandos.
+  if ( campo.datos == NULL )
+    cadena_inicializar ( &campo );
+  for ( i = 0; i < tuberia->numComandos; ++i )
   {
-    return linea;
+    for ( j = 0; j < tuberia->comandos[i].numPalabras; ++j )
+      expandir_palabra ( &(tuberia->comandos[i]), &(tuberia->comandos[i].palabras[j]), &campo, arena );
   }
 }
 
@@ -27,16 +27,21 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       comodines.h
- * DESCRIPCIN:   Comodines y sugerencias.
+ * DESCRIPCIÓN:   Comodines y sugerencias.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #pragma once
 
+#include "analizador.h"
 #include "io.h"
 
 void procesar_sugerencias ( Linea* linea );
-char* reemplazar_comodines ( char* linea, char* nuevaLinea );
+
+// Último paso de la expansión: genera los argumentos de cada comando de la
+// pipeline, partiendo el resultado de las expansiones sin comillas y
+// sustituyendo los comodines que no estén entre comillas.
+void comodines_expandir ( Tuberia* tuberia, Arena* arena );
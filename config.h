@@ -1,10 +1,16 @@
 #pragma once
 
-#define MAX_LINEA 1024
-#define MAX_ARGS 64
+#define TAMANYO_INICIAL_LINEA 256
 #define PROMPT_POR_DEFECTO "> "
+#define PROMPT_SECUNDARIO "> "
 #define MAX_HISTORIAL 100
 #define FICHERO_HISTORIAL "./.bashinga_history"
-#define MAX_PROGRAMAS_POR_LINEA 5
 #define VARIABLES_TABLA_HASH_TAMANYO 512
 #define ALIASES_TABLA_HASH_TAMANYO 512
+#define RUTAS_TABLA_HASH_TAMANYO 256
+#define TAMANYO_BUFFER_ENTRADA 4096
+#define TAMANYO_BUFFER_SALIDA 8192
+#define TAMANYO_BUFFER_LECTOR 65536
+#define ARENA_TAMANYO_BLOQUE 16384
+#define LOTES_MARGEN_ARGUMENTOS 2048
+#define LEXICO_TAMANYO_MAXIMO_TOKEN 64
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       documentos.c
+ * DESCRIPCIÓN:   Here-documents (<<DELIM, <<-DELIM) y here-strings (<<<texto).
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#define _GNU_SOURCE             // memfd_create
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "analizador.h"
+#include "arena.h"
+#include "documentos.h"
+#include "tuberias.h"
+
+// Copia el delimitador tal y como se escribió, sin sus comillas. No se
+// expande, así que las variables y sustituciones recuperan su forma escrita.
+static char* copiar_delimitador ( const Palabra* palabra )
+{
+  Cadena delimitador;
+  int i;
+
+  cadena_inicializar ( &delimitador );
+  for ( i = 0; i < palabra->numPartes; ++i )
+  {
+    const PartePalabra* parte = &(palabra->partes[i]);
+
+    if ( parte->tipo == PARTE_VARIABLE )
+    {
+      cadena_anyadir_caracter ( &delimitador, '$' );
+      cadena_anyadir ( &delimitador, parte->texto );
+    }
+    else if ( parte->tipo == PARTE_SUSTITUCION )
+    {
+      cadena_anyadir ( &delimitador, "$(" );
+      cadena_anyadir ( &delimitador, parte->texto );
+      cadena_anyadir_caracter ( &delimitador, ')' );
+    }
+    else
+    {
+      cadena_anyadir ( &delimitador, parte->texto );
+    }
+  }
+
+  return delimitador.datos;
+}
+
+// Cuenta los here-documents de la linea o, si ya están contados, anota el
+// delimitador y el operador de cada uno en su posición.
+static void recorrer_documentos ( Documentos* docs, const ArbolLinea* arbol, int anotar )
+{
+  int i;
+  int j;
+  int k;
+
+  for ( i = 0; i < arbol->numTuberias; ++i )
+  {
+    for ( j = 0; j < arbol->tuberias[i].numComandos; ++j )
+    {
+      const Comando* comando = &(arbol->tuberias[i].comandos[j]);
+
+      for ( k = 0; k < comando->numRedirecciones; ++k )
+      {
+        const Redireccion* redireccion = &(comando->redirecciones[k]);
+
+        if ( redireccion->tipo != REDIRECCION_DOCUMENTO )
+          continue;
+        if ( !anotar )
+        {
+          docs->numDocumentos++;
+          continue;
+        }
+        docs->delimitadores [ redireccion->documento ] = copiar_delimitador ( &(redireccion->destino) );
+        docs->quitarTabuladores [ redireccion->documento ] = redireccion->quitarTabuladores;
+      }
+    }
+  }
+}
+
+void documentos_inicializar ( Documentos* docs, const char* linea )
+{
+  ArbolLinea arbol;
+  Arena arena;
+  int i;
+
+  memset ( docs, 0, sizeof(Documentos) );
+
+  // Los operadores salen del mismo análisis con el que se ejecutará la linea,
+  // así que las comillas y los comentarios se tratan igual. Si hay errores de
+  // sintaxis no se espera ningún cuerpo: se informará de ellos al ejecutarla.
+  arena_inicializar ( &arena );
+  if ( analizador_procesar_en_silencio ( &arbol, linea, &arena ) == -1 )
+  {
+    arena_liberar ( &arena );
+    return;
+  }
+
+  recorrer_documentos ( docs, &arbol, 0 );
+  if ( docs->numDocumentos > 0 )
+  {
+    docs->delimitadores = (char **)malloc ( sizeof(char *) * docs->numDocumentos );
+    docs->quitarTabuladores = (int *)malloc ( sizeof(int) * docs->numDocumentos );
+    docs->cuerpos = (Cadena *)malloc ( sizeof(Cadena) * docs->numDocumentos );
+    recorrer_documentos ( docs, &arbol, 1 );
+    for ( i = 0; i < docs->numDocumentos; ++i )
+      cadena_inicializar ( &(docs->cuerpos[i]) );
+  }
+
+  arena_liberar ( &arena );
+}
+
+void documentos_liberar ( Documentos* docs )
+{
+  int i;
+
+  for ( i = 0; i < docs->numDocumentos; ++i )
+  {
+    free ( docs->delimitadores[i] );
+    cadena_liberar ( &(docs->cuerpos[i]) );
+  }
+  free ( docs->delimitadores );
+  free ( docs->quitarTabuladores );
+  free ( docs->cuerpos );
+  memset ( docs, 0, sizeof(Documentos) );
+}
+
+int documentos_pendientes ( const Documentos* docs )
+{
+  return docs->numDocumentos - docs->leidos;
+}
+
+void documentos_anyadir_linea ( Documentos* docs, const char* linea )
+{
+  int actual = docs->leidos;
+
+  if ( actual >= docs->numDocumentos )
+    return;
+
+  if ( docs->quitarTabuladores[actual] )
+  {
+    while ( *linea == '\t' )
+      ++linea;
+  }
+
+  // El delimitador termina el cuerpo y no forma parte de él.
+  if ( strcmp ( linea, docs->delimitadores[actual] ) == 0 )
+  {
+    docs->leidos++;
+  }
+  else
+  {
+    cadena_anyadir ( &(docs->cuerpos[actual]), linea );
+    cadena_anyadir_caracter ( &(docs->cuerpos[actual]), '\n' );
+  }
+}
+
+const Cadena* documentos_obtener ( Documentos* docs, int documento )
+{
+  if ( ( docs == NULL ) || ( documento < 0 ) || ( documento >= docs->numDocumentos ) )
+    return NULL;
+  return &(docs->cuerpos [ documento ]);
+}
+
+static int escribir_todo ( int fd, const char* datos, int len )
+{
+  int n;
+
+  while ( len > 0 )
+  {
+    n = write ( fd, datos, len );
+    if ( n == -1 )
+    {
+      if ( errno == EINTR )
+        continue;
+      return -1;
+    }
+    datos += n;
+    len -= n;
+  }
+
+  return 0;
+}
+
+int documentos_crear_entrada ( const char* datos, int len )
+{
+  int fds[2];
+  int fd;
+
+  // Hasta PIPE_BUF bytes caben siempre en un pipe vacío, así que podemos
+  // escribirlos antes de lanzar al programa sin riesgo de bloquearnos.
+  if ( len <= PIPE_BUF )
+  {
+    if ( tuberias_crear ( fds, 0 ) == -1 )
+      return -1;
+
+    if ( escribir_todo ( fds[1], datos, len ) == -1 )
+    {
+      close ( fds[0] );
+      close ( fds[1] );
+      return -1;
+    }
+
+    close ( fds[1] );
+    return fds[0];
+  }
+
+  // Los cuerpos mayores van a un fichero anónimo en memoria, que el programa
+  // lee desde el principio como si fuese un fichero normal.
+  fd = memfd_create ( "documento", MFD_CLOEXEC );
+  if ( fd == -1 )
+    return -1;
+
+  if ( ( escribir_todo ( fd, datos, len ) == -1 ) || ( lseek ( fd, 0, SEEK_SET ) == -1 ) )
+  {
+    close ( fd );
+    return -1;
+  }
+
+  return fd;
+}
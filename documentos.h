@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       documentos.h
+ * DESCRIPCIÓN:   Here-documents (<<DELIM, <<-DELIM) y here-strings (<<<texto).
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#pragma once
+
+#include "cadena.h"
+
+// Cuerpos de los here-documents de una linea de comandos, en el mismo orden
+// en el que aparecen sus operadores en la linea.
+typedef struct
+{
+  int numDocumentos;
+  char** delimitadores;
+  int* quitarTabuladores;   // Operador <<-: se quitan los tabuladores iniciales.
+  Cadena* cuerpos;
+  int leidos;               // Cuerpos ya terminados por su delimitador.
+} Documentos;
+
+// Analiza la linea para saber qué delimitadores esperar.
+void documentos_inicializar ( Documentos* docs, const char* linea );
+void documentos_liberar ( Documentos* docs );
+
+// Número de cuerpos a los que aún les faltan lineas.
+int documentos_pendientes ( const Documentos* docs );
+
+// Añade una linea leída tras la linea de comandos al cuerpo que se está leyendo.
+void documentos_anyadir_linea ( Documentos* docs, const char* linea );
+
+// Devuelve el cuerpo del here-document con ese número dentro de la linea, o
+// NULL si no existe.
+const Cadena* documentos_obtener ( Documentos* docs, int documento );
+
+// Devuelve un descriptor, con O_CLOEXEC, del que se leen desde el principio los
+// datos dados. Nunca se crean ficheros en disco: los datos pequeños se dejan
+// en un pipe y los demás en un fichero anónimo en memoria (memfd).
+int documentos_crear_entrada ( const char* datos, int len );
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       eventos.c
+ * DESCRIPCIÓN:   Bucle de eventos: entrada estándar y señales desde un único punto.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/signalfd.h>
+#include <time.h>
+#include <unistd.h>
+#include "eventos.h"
+
+static int eventos_fdSenyales = -1;
+static sigset_t eventos_senyales;
+static sigset_t eventos_mascaraOriginal;
+
+int eventos_inicializar ()
+{
+  sigemptyset ( &eventos_senyales );
+  sigaddset ( &eventos_senyales, SIGINT );
+  sigaddset ( &eventos_senyales, SIGTERM );
+  sigaddset ( &eventos_senyales, SIGCHLD );
+  sigaddset ( &eventos_senyales, SIGWINCH );
+
+  // Con las señales bloqueadas, ninguna interrumpe al shell a medias: quedan
+  // pendientes hasta que el bucle las lee del signalfd.
+  if ( sigprocmask ( SIG_BLOCK, &eventos_senyales, &eventos_mascaraOriginal ) == -1 )
+    return -1;
+
+  eventos_fdSenyales = signalfd ( -1, &eventos_senyales, SFD_NONBLOCK | SFD_CLOEXEC );
+  if ( eventos_fdSenyales == -1 )
+  {
+    sigprocmask ( SIG_SETMASK, &eventos_mascaraOriginal, NULL );
+    return -1;
+  }
+
+  return 0;
+}
+
+void eventos_finalizar ()
+{
+  if ( eventos_fdSenyales != -1 )
+  {
+    close ( eventos_fdSenyales );
+    eventos_fdSenyales = -1;
+    sigprocmask ( SIG_SETMASK, &eventos_mascaraOriginal, NULL );
+  }
+}
+
+static int eventos_leer_senyal ( Evento* evento )
+{
+  struct signalfd_siginfo info;
+  int n;
+
+  n = read ( eventos_fdSenyales, &info, sizeof(info) );
+  if ( n != sizeof(info) )
+    return 0;
+
+  evento->tipo = EVENTO_SENYAL;
+  evento->senyal = info.ssi_signo;
+  return 1;
+}
+
+int eventos_esperar ( Evento* evento )
+{
+  struct pollfd fds [ 2 ];
+  int n;
+
+  memset ( evento, 0, sizeof(Evento) );
+
+  while ( 1 )
+  {
+    // Atendemos primero las señales ya pendientes.
+    if ( ( eventos_fdSenyales != -1 ) && eventos_leer_senyal ( evento ) )
+      return 0;
+
+    fds[0].fd = 0;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = eventos_fdSenyales;
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+
+    n = poll ( fds, ( eventos_fdSenyales != -1 ) ? 2 : 1, -1 );
+    if ( n == -1 )
+    {
+      if ( errno == EINTR )
+        continue;
+      evento->tipo = EVENTO_ERROR;
+      return -1;
+    }
+
+    if ( fds[1].revents & POLLIN )
+      continue;
+
+    // Un fin de fichero o un error se detectan al leer la entrada.
+    if ( fds[0].revents & ( POLLIN | POLLHUP | POLLERR | POLLNVAL ) )
+    {
+      evento->tipo = EVENTO_ENTRADA;
+      return 0;
+    }
+  }
+}
+
+int eventos_descartar_senyal ( int senyal )
+{
+  sigset_t conjunto;
+  struct timespec nada = { 0, 0 };
+  int descartadas = 0;
+
+  if ( eventos_fdSenyales == -1 )
+    return 0;
+
+  sigemptyset ( &conjunto );
+  sigaddset ( &conjunto, senyal );
+  while ( sigtimedwait ( &conjunto, NULL, &nada ) > 0 )
+    ++descartadas;
+
+  return descartadas;
+}
+
+int eventos_mascara_original ( sigset_t* mascara )
+{
+  if ( eventos_fdSenyales == -1 )
+    return 0;
+
+  *mascara = eventos_mascaraOriginal;
+  return 1;
+}
+
+void eventos_restaurar_hijo ()
+{
+  if ( eventos_fdSenyales != -1 )
+    sigprocmask ( SIG_SETMASK, &eventos_mascaraOriginal, NULL );
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       eventos.h
+ * DESCRIPCIÓN:   Bucle de eventos: entrada estándar y señales desde un único punto.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#pragma once
+
+#include <signal.h>
+
+typedef enum
+{
+  EVENTO_ENTRADA,       // Hay datos para leer en la entrada estándar.
+  EVENTO_SENYAL,        // Se ha recibido una señal.
+  EVENTO_ERROR
+} TipoEvento;
+
+typedef struct
+{
+  TipoEvento tipo;
+  int senyal;           // Número de señal para EVENTO_SENYAL.
+} Evento;
+
+// Bloquea las señales que atiende el bucle (SIGINT, SIGTERM, SIGCHLD y SIGWINCH)
+// para recibirlas a través de un signalfd en lugar de en un manejador.
+int eventos_inicializar ();
+void eventos_finalizar ();
+
+// Espera al siguiente evento. Las señales tienen prioridad sobre la entrada.
+int eventos_esperar ( Evento* evento );
+
+// Descarta las señales de un tipo que estén pendientes, devolviendo si había alguna.
+int eventos_descartar_senyal ( int senyal );
+
+// Obtiene la máscara de señales anterior a eventos_inicializar. Devuelve 0 si
+// el bucle de eventos no está activo y la máscara no ha cambiado.
+int eventos_mascara_original ( sigset_t* mascara );
+
+// Los procesos hijos deben llamar a esta función antes de ejecutar un programa,
+// para que éste reciba las señales con la máscara original.
+void eventos_restaurar_hijo ();
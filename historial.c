@@ -27,11 +27,11 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       historial.c
- * DESCRIPCIN:   Control del historial.
+ * DESCRIPCIÓN:   Control del historial.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #include <fcntl.h>
@@ -40,6 +40,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include "cadena.h"
 #include "historial.h"
 #include "io.h"
 
@@ -67,8 +68,6 @@ Historial* historial_crear ( int p_maxHistorial )
 
   const char* maxHistorial = getenv ( "HISTORY_LENGTH" );
   int iMaxHistorial;
-  int i;
-  char* datosLineas;
 
   // Intentamos coger el tamanyo del historial desde el parametro o una variable de entorno.
   // En caso de no existir esta, cogemos el valor por defecto.
@@ -81,29 +80,30 @@ Historial* historial_crear ( int p_maxHistorial )
 
   hist->maxTamanyo = iMaxHistorial;
 
-  // Reservamos memoria para las lineas.
-  hist->lineas = (char **)malloc( sizeof(char*) * iMaxHistorial );
-  datosLineas = (char *)malloc( sizeof(char) * MAX_LINEA * iMaxHistorial );
-
-  // Inicializamos los apuntadores.
-  for ( i = 0; i < iMaxHistorial; i++ )
-  {
-    hist->lineas [ i ] = &(datosLineas[i * MAX_LINEA]);
-  }
+  // Reservamos los apuntadores a las lineas. Cada linea se reserva al
+  // añadirla con el tamaño justo que necesita.
+  hist->lineas = (char **)calloc( iMaxHistorial, sizeof(char*) );
 
   return hist;
 }
 
 void historial_eliminar ( Historial* hist )
 {
-  free ( hist->lineas[0] );
+  int i;
+
+  for ( i = 0; i < hist->maxTamanyo; i++ )
+    free ( hist->lineas[i] );
   free ( hist->lineas );
   free ( hist );
 }
 
 void historial_anyadir ( Historial* hist, char* linea )
 {
-  strcpy ( hist->lineas[hist->cursor], linea );
+  // Si el historial está lleno, la nueva linea sustituye a la más antigua.
+  // Copiamos antes de liberar, por si la linea viene del propio historial.
+  char* copia = strdup ( linea );
+  free ( hist->lineas[hist->cursor] );
+  hist->lineas[hist->cursor] = copia;
   hist->cursor = ( hist->cursor + 1 ) % hist->maxTamanyo;
   if ( hist->cursor == 0 )
     hist->lleno = 1;
@@ -236,16 +236,16 @@ char* historial_empieza_por ( Historial* hist, char* por )
 
 char* historial_obtener ( Historial* hist, int pos )
 {
-  // Ajustamos la posicin requerida al rango.
+  // Ajustamos la posición requerida al rango.
   if ( !hist->lleno && ( hist->cursor == 0 ) )
   {
-    // Est vaco.
+    // Está vacío.
     return NULL;
   }
 
   if ( pos >= hist->maxTamanyo || ( !hist->lleno && pos >= hist->cursor ) )
   {
-    // Es mayor que el tamao del historial.
+    // Es mayor que el tamaño del historial.
     return NULL;
   }
 
@@ -255,20 +255,19 @@ char* historial_obtener ( Historial* hist, int pos )
     return NULL;
   }
 
-  // Calculamos la posicin real dentro del buffer circular.
+  // Calculamos la posición real dentro del buffer circular.
   pos = (( hist->cursor - pos - 1 ) + hist->maxTamanyo) % hist->maxTamanyo;
 
-  // El -1 podra generar problemas si se elimina la primera comprobacin de este algoritmo.
+  // El -1 podría generar problemas si se elimina la primera comprobación de este algoritmo.
   return hist->lineas [ pos ];
 }
 
 void historial_cargar_desde_fichero ( Historial* hist, const char* fichero )
 {
   int fd = open ( fichero, O_RDONLY );
-  char linea [ MAX_LINEA ];
+  Cadena linea;
   char c;
   int n;
-  int nBytes = 0;
 
   // Inicializamos el historial.
   hist->cursor = 0;
@@ -278,6 +277,7 @@ void historial_cargar_desde_fichero ( Historial* hist, const char* fichero )
   {
     int continuar = 1;
 
+    cadena_inicializar ( &linea );
     while ( continuar )
     {
       do
@@ -287,17 +287,15 @@ void historial_cargar_desde_fichero ( Historial* hist, const char* fichero )
         {
           if ( c == '\n' )
           {
-            if ( nBytes > 0 )
+            if ( linea.len > 0 )
             {
-              linea [ nBytes ] = '\0';
-              nBytes = 0;
-              historial_anyadir ( hist, linea );
+              historial_anyadir ( hist, linea.datos );
+              cadena_vaciar ( &linea );
             }
           }
           else
           {
-            linea [ nBytes ] = c;
-            ++nBytes;
+            cadena_anyadir_caracter ( &linea, c );
           }
         }
         else
@@ -305,6 +303,7 @@ void historial_cargar_desde_fichero ( Historial* hist, const char* fichero )
       } while ( ( n > 0 ) && ( c != '\n' ) );
     }
 
+    cadena_liberar ( &linea );
     close ( fd );
   }
 }
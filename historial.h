@@ -27,11 +27,11 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       historial.h
- * DESCRIPCIN:   Control del historial.
+ * DESCRIPCIÓN:   Control del historial.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #pragma once
@@ -27,20 +27,21 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       io.c
- * DESCRIPCIN:   Entrada/Salida y control de la linea de comandos.
+ * DESCRIPCIÓN:   Entrada/Salida y control de la linea de comandos.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <termio.h>
 #include <unistd.h>
 #include "io.h"
+#include "pantalla.h"
 #include "prompt.h"
+#include "sesion.h"
 #include "terminal.h"
 
 // Escritura a ficheros con formato
@@ -70,152 +71,261 @@ int writef ( int fd, const char* format, ... )
 }
 
 
-// Lectura de un caracter
-int getch(char* c)
+// Buffer de salida
+static char salida_buffer [ TAMANYO_BUFFER_SALIDA ];
+static int salida_len = 0;
+static int salida_bytesFrame = 0;
+static int salida_llamadasFrame = 0;
+static EstadisticasSalida salida_estadisticas;
+
+static void salida_vaciar_buffer ()
+{
+  int enviados = 0;
+  int n;
+
+  while ( enviados < salida_len )
+  {
+    n = write ( 1, &(salida_buffer[enviados]), salida_len - enviados );
+    salida_llamadasFrame++;
+    if ( n > 0 )
+      enviados += n;
+    else if ( ( n == -1 ) && ( errno != EINTR ) )
+      break;
+  }
+
+  salida_bytesFrame += salida_len;
+  salida_len = 0;
+}
+
+void salida_escribir ( const char* datos, int n )
 {
-    int ret;
-    struct termio param_save, misparam;
+  while ( n > 0 )
+  {
+    int hueco = TAMANYO_BUFFER_SALIDA - salida_len;
+    if ( hueco == 0 )
+    {
+      salida_vaciar_buffer ();
+      hueco = TAMANYO_BUFFER_SALIDA;
+    }
+    if ( hueco > n )
+      hueco = n;
+
+    memcpy ( &(salida_buffer[salida_len]), datos, hueco );
+    salida_len += hueco;
+    datos += hueco;
+    n -= hueco;
+  }
+}
 
-    /* -- lectura de parametros dispositivo --- */
-    ioctl(0, TCGETA,  &param_save);
+int salida_escribirf ( const char* format, ... )
+{
+  char buffer [ 1024 ];
+  va_list vl;
+  int size;
 
-    /* --- programacion del dispositivo --- */
-    misparam = param_save;
-    /* quitamos eco local y modo canonico */
-    misparam.c_lflag &= ~(ICANON | ECHO);
-    /* devolver entrada cuando haya 1 caracter en buffer */
-    misparam.c_cc[4]=1;
-    /* pone nuevos parametros */
-    ioctl(0, TCSETA, &misparam );
+  va_start ( vl, format );
+  size = vsnprintf ( buffer, sizeof(buffer), format, vl );
+  va_end ( vl );
 
-    /* --- lectura de la entrada --- */
-    ret = read(0, c, 1);
+  if ( size >= (int)sizeof(buffer) )
+    size = sizeof(buffer) - 1;
+  if ( size > 0 )
+    salida_escribir ( buffer, size );
+  return size;
+}
 
-    /* --- reponemos parametros dispositivo --- */
-    ioctl(0, TCSETA, &param_save );
+void salida_volcar ()
+{
+  // Cerramos el frame actual y actualizamos los contadores.
+  if ( salida_len > 0 )
+    salida_vaciar_buffer ();
 
-    return ret;
+  if ( salida_bytesFrame > 0 )
+  {
+    salida_estadisticas.bytesFrame = salida_bytesFrame;
+    salida_estadisticas.llamadasFrame = salida_llamadasFrame;
+    salida_estadisticas.bytesTotales += salida_bytesFrame;
+    salida_estadisticas.llamadasTotales += salida_llamadasFrame;
+    salida_estadisticas.frames++;
+    salida_bytesFrame = 0;
+    salida_llamadasFrame = 0;
+  }
+}
+
+const EstadisticasSalida* salida_obtener_estadisticas ()
+{
+  return &salida_estadisticas;
+}
+
+
+// Lectura de un caracter
+int getch ( char* c )
+{
+  // La sesión mantiene el terminal en modo crudo y lee la entrada por bloques.
+  return sesion_leer ( sesion_obtener_instancia (), c );
 }
 
 // Eco
 void hacer_eco ( char c )
 {
-  struct termio tm;
-
   // Comprobamos que el eco este activo
-  ioctl(0, TCGETA, &tm);
-
-  if ( tm.c_lflag & ECHO )
-    write ( 1, &c, 1 );
+  if ( sesion_eco_activo ( sesion_obtener_instancia () ) )
+    salida_escribir ( &c, 1 );
 }
 
 
 // Lineas
+// Las funciones de edición sólo modifican la linea. Es pantalla_actualizar()
+// quien se encarga de mostrar las diferencias al final de cada evento.
+#define TAMANYO_HUECO(linea) ( (linea)->capacidad - (linea)->len )
+
 void linea_inicializar ( Linea* linea )
 {
   memset ( linea, 0, sizeof(Linea) );
+  linea->capacidad = TAMANYO_INICIAL_LINEA;
+  linea->buffer = (char *)malloc ( linea->capacidad );
+  lexico_inicializar ( &(linea->lexico) );
 }
 
-void linea_anyadir ( Linea* linea, char c, void (*mostrarFn)(char) )
+void linea_vaciar ( Linea* linea )
 {
-  if ( linea->escape.len > 0 )
+  linea->hueco = 0;
+  linea->len = 0;
+  linea->cursor = 0;
+  linea_limpiar_secuencia_escape ( linea );
+  lexico_vaciar ( &(linea->lexico) );
+}
+
+void linea_liberar ( Linea* linea )
+{
+  free ( linea->buffer );
+  lexico_liberar ( &(linea->lexico) );
+  memset ( linea, 0, sizeof(Linea) );
+}
+
+static void linea_mover_hueco ( Linea* linea, int posicion )
+{
+  int hueco = TAMANYO_HUECO ( linea );
+
+  if ( posicion < linea->hueco )
   {
-    linea_anyadir_secuencia_escape ( linea, c, mostrarFn );
+    // Pasamos al final del hueco lo que hay entre la posición y el hueco.
+    memmove ( &(linea->buffer [ posicion + hueco ]), &(linea->buffer [ posicion ]), linea->hueco - posicion );
   }
-  else
+  else if ( posicion > linea->hueco )
   {
-    if ( linea->cursor < linea->len )
-    {
-      // Nos encontramos en el caso en el que el cursor no esta al final de la linea y requiere desplazar.
-      int i;
-      for ( i = linea->len; i > linea->cursor; i-- )
-      {
-        linea->buffer [ i ] = linea->buffer [ i - 1 ];
-      }
-    }
-
-    // Anyadimos el caracter leido en la posicion actual del cursor.
-    linea->buffer [ linea->cursor ] = c;
-    linea->cursor++;
-    linea->len++;
-
-    if ( mostrarFn )
-    {
-      ejecutar_secuencia_escape ( LINEA_LIMPIAR_DERECHA );
-      mostrarFn ( c );
-      linea_mostrar_desde_cursor ( linea );
-    }
+    // Pasamos al comienzo del hueco lo que hay entre el hueco y la posición.
+    memmove ( &(linea->buffer [ linea->hueco ]), &(linea->buffer [ linea->hueco + hueco ]), posicion - linea->hueco );
   }
+  linea->hueco = posicion;
 }
 
-void linea_anyadir_secuencia_escape ( Linea* linea, char c, void (*mostrarFn)(char) )
+static void linea_reservar ( Linea* linea, int n )
 {
-  linea->escape.bytes [ linea->escape.len ] = c;
-  linea->escape.len++;
+  // Siempre dejamos al menos un byte de hueco para el fin de cadena.
+  if ( TAMANYO_HUECO ( linea ) < ( n + 1 ) )
+  {
+    int capacidad = linea->capacidad * 2;
+    int tras = linea->len - linea->hueco;
+    if ( capacidad < ( linea->len + n + 1 ) )
+      capacidad = linea->len + n + 1;
+
+    linea->buffer = (char *)realloc ( linea->buffer, capacidad );
+
+    // Lo que había tras el hueco pasa al nuevo final del buffer.
+    memmove ( &(linea->buffer [ capacidad - tras ]), &(linea->buffer [ linea->capacidad - tras ]), tras );
+    linea->capacidad = capacidad;
+  }
 }
 
-void linea_limpiar_secuencia_escape ( Linea* linea )
+void linea_anyadir ( Linea* linea, char c )
 {
-  linea->escape.len = 0;
+  if ( linea->escape.len > 0 )
+  {
+    linea_anyadir_secuencia_escape ( linea, c );
+  }
+  else
+  {
+    linea_insertar ( linea, &c, 1 );
+  }
 }
 
-void linea_mostrar_intervalo ( Linea* linea, int inicio, int n )
+void linea_insertar ( Linea* linea, const char* texto, int n )
 {
-  write ( 1, &(linea->buffer[inicio]), n );
+  if ( n <= 0 )
+    return;
+
+  // Llevamos el hueco hasta el cursor e insertamos el texto en él.
+  linea_reservar ( linea, n );
+  linea_mover_hueco ( linea, linea->cursor );
+  memcpy ( &(linea->buffer [ linea->hueco ]), texto, n );
+  linea->hueco += n;
+  linea->cursor += n;
+  linea->len += n;
+  lexico_actualizar ( &(linea->lexico), linea, linea->hueco - n, 0, n );
 }
 
-void linea_mostrar_desde_cursor ( Linea* linea )
+void linea_anyadir_secuencia_escape ( Linea* linea, char c )
 {
-  // Imprime todos los caracteres desde la posicion del cursor hasta el final.
-  if ( linea->cursor < linea->len )
+  if ( linea->escape.len < sizeof(linea->escape.bytes) )
   {
-    write ( 1, &(linea->buffer [ linea->cursor ]), linea->len - linea->cursor );
-    // Restaura el cursor a la posicion anterior.
-    ejecutar_secuencia_escape_repetir ( FLECHA_IZQUIERDA, linea->len - linea->cursor );
+    linea->escape.bytes [ linea->escape.len ] = c;
+    linea->escape.len++;
   }
 }
 
-void linea_mostrar_secuencia_escape ( Linea* linea, void (*mostrarFn)(char) )
+void linea_limpiar_secuencia_escape ( Linea* linea )
 {
-  if ( linea->escape.len > 0 )
-  {
-    int i;
-    for ( i = 0; i < linea->escape.len; ++i )
-    {
-      mostrarFn ( linea->escape.bytes [ i ] );
-    }
-  }
+  linea->escape.len = 0;
+  linea->escape.procesados = 0;
+  linea->escape.estado = 0;
 }
 
 char* linea_hacer_string ( Linea* linea )
 {
-  // Ponemos el fin de cadena en el buffer para que pueda procesarse como string.
+  // Llevamos el hueco al final para que el contenido quede contiguo, y ponemos
+  // el fin de cadena en el buffer para que pueda procesarse como string.
+  // El string deja de ser válido en cuanto se modifica la linea.
+  linea_mover_hueco ( linea, linea->len );
   linea->buffer[linea->len] = '\0';
 
   return linea->buffer;
 }
 
+char linea_caracter ( Linea* linea, int posicion )
+{
+  if ( posicion < linea->hueco )
+    return linea->buffer [ posicion ];
+  else
+    return linea->buffer [ posicion + TAMANYO_HUECO ( linea ) ];
+}
+
+void linea_copiar ( Linea* linea, int inicio, int fin, char* destino )
+{
+  // Copiamos el intervalo sin mover el hueco.
+  if ( inicio < linea->hueco )
+  {
+    int n = ( ( fin < linea->hueco ) ? fin : linea->hueco ) - inicio;
+    memcpy ( destino, &(linea->buffer [ inicio ]), n );
+    destino += n;
+    inicio += n;
+  }
+  if ( inicio < fin )
+  {
+    memcpy ( destino, &(linea->buffer [ inicio + TAMANYO_HUECO ( linea ) ]), fin - inicio );
+  }
+}
+
 void linea_backspace ( Linea* linea )
 {
   if ( linea->cursor > 0 )
   {
-    if ( linea->cursor < linea->len )
-    {
-      // Nos encontramos en el caso en el que el cursor no estaba al final de la linea.
-      // Requiere desplazar.
-      int i;
-      for ( i = linea->cursor - 1; i < (linea->len - 1); i++ )
-      {
-        linea->buffer [ i ] = linea->buffer [ i + 1 ];
-      }
-    }
+    // El caracter anterior al cursor pasa a formar parte del hueco.
+    linea_mover_hueco ( linea, linea->cursor );
+    linea->hueco--;
     linea->cursor--;
     linea->len--;
-
-    // Mostramos el backspace
-    write ( 1, "\177", 1 );
-    ejecutar_secuencia_escape ( LINEA_LIMPIAR_DERECHA );
-    linea_mostrar_desde_cursor ( linea );
+    lexico_actualizar ( &(linea->lexico), linea, linea->cursor, 1, 0 );
   }
 }
 
@@ -223,44 +333,28 @@ void linea_suprimir ( Linea* linea )
 {
   if ( linea->cursor < linea->len )
   {
-    // Nos encontramos en el caso en el que el cursor no estaba al final de la linea.
-    // Requiere desplazar.
-    int i;
-    for ( i = linea->cursor; i < linea->len; i++ )
-    {
-      linea->buffer [ i ] = linea->buffer [ i + 1 ];
-    }
+    // El caracter posterior al cursor pasa a formar parte del hueco.
+    linea_mover_hueco ( linea, linea->cursor );
     linea->len--;
-
-    ejecutar_secuencia_escape ( LINEA_LIMPIAR_DERECHA );
-    linea_mostrar_desde_cursor ( linea );
+    lexico_actualizar ( &(linea->lexico), linea, linea->cursor, 1, 0 );
   }
 }
 
 void linea_cargar_contenido ( Linea* linea, char* contenido )
 {
-  linea_inicializar ( linea );
-  strcpy ( linea->buffer, contenido );
-  linea->len = strlen ( linea->buffer );
-  linea->cursor = linea->len;
+  linea_vaciar ( linea );
+  linea_insertar ( linea, contenido, strlen ( contenido ) );
 }
 
 void linea_mostrar_reset ( Linea* linea )
 {
-  write ( 1, "\r", 1 );
-  mostrar_prompt ();
-  write ( 1, linea->buffer, linea->len );
-
-  ejecutar_secuencia_escape ( LINEA_LIMPIAR_DERECHA );
-
-  // Restauramos el cursor a su posicin original.
-  ejecutar_secuencia_escape_repetir ( FLECHA_IZQUIERDA, linea->len - linea->cursor );
+  // Volvemos a mostrar el prompt y la linea completa.
+  pantalla_invalidar ();
+  pantalla_actualizar ( linea );
 }
 
-int linea_procesar_secuencia_escape ( Linea* linea, CodigoSecuencia codigo )
+void linea_procesar_secuencia_escape ( Linea* linea, CodigoSecuencia codigo )
 {
-  int mostrarSecuencia = 1;
-
   // Procesamos el codigo de secuencia en caso de exito.
   switch ( codigo )
   {
@@ -270,10 +364,6 @@ int linea_procesar_secuencia_escape ( Linea* linea, CodigoSecuencia codigo )
       {
         linea->cursor--;
       }
-      else
-      {
-        mostrarSecuencia = 0;
-      }
       break;
 
     case FLECHA_DERECHA:
@@ -281,42 +371,32 @@ int linea_procesar_secuencia_escape ( Linea* linea, CodigoSecuencia codigo )
       {
         linea->cursor++;
       }
-      else
-      {
-        mostrarSecuencia = 0;
-      }
       break;
 
     case LINEA_SUPRIMIR:
       linea_suprimir ( linea );
-      mostrarSecuencia = 0;
       break;
 
     case IR_INICIO:
-    {
-      ejecutar_secuencia_escape_repetir ( FLECHA_IZQUIERDA, linea->cursor );
       linea->cursor = 0;
-      mostrarSecuencia = 0;
       break;
-    }
 
     case IR_FINAL:
-    {
-      ejecutar_secuencia_escape_repetir ( FLECHA_DERECHA, linea->len - linea->cursor );
       linea->cursor = linea->len;
-      mostrarSecuencia = 0;
       break;
-    }
 
     default:
       break;
   }
-
-  return mostrarSecuencia;
 }
 
 void linea_eliminar_desde_cursor ( Linea* linea )
 {
+  // Todo lo que hay tras el cursor pasa a formar parte del hueco.
+  int borrados = linea->len - linea->cursor;
+
+  linea_mover_hueco ( linea, linea->cursor );
   linea->len = linea->cursor;
+  if ( borrados > 0 )
+    lexico_actualizar ( &(linea->lexico), linea, linea->cursor, borrados, 0 );
 }
-
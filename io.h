@@ -27,11 +27,11 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       io.h
- * DESCRIPCIN:   Entrada/Salida y control de la linea de comandos.
+ * DESCRIPCIÓN:   Entrada/Salida y control de la linea de comandos.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #pragma once
@@ -41,6 +41,7 @@
 #include <errno.h>
 #include "config.h"
 #include "codigos_secuencia.h"
+#include "lexico.h"
 
 // Errores
 #define error(x) do { perror(x); exit(-1); } while(0)
@@ -49,36 +50,61 @@
 int vwritef ( int fd, const char* format, va_list vl );
 int writef ( int fd, const char* format, ... );
 
-// Lectura de un caracter (http://www.canalc.hispla.com/foro/viewtopic.php?f=31&t=45)
+// Buffer de salida del editor. Todo lo que se muestra mientras se edita la
+// linea se acumula en un frame que se envía al terminal de una sola vez.
+typedef struct
+{
+  int bytesFrame;             // Bytes enviados en el último frame.
+  int llamadasFrame;          // Llamadas a write() en el último frame.
+  long bytesTotales;
+  long llamadasTotales;
+  long frames;
+} EstadisticasSalida;
+
+void salida_escribir ( const char* datos, int n );
+int salida_escribirf ( const char* format, ... );
+void salida_volcar ();
+const EstadisticasSalida* salida_obtener_estadisticas ();
+
+// Lectura de un caracter desde la sesión de terminal.
 int getch ( char* c );
 
 // Eco
 void hacer_eco ( char c );
 
-// Declaramos los tipos de datos para las lineas.
+// Declaramos los tipos de datos para las lineas. El contenido se guarda en un
+// buffer con un hueco (gap buffer) que se desplaza hasta el punto de edición,
+// de forma que insertar y borrar en el cursor no requiere mover el resto.
 typedef struct _Linea
 {
-  char buffer [ MAX_LINEA ];  // Contenido de la linea.
-  int len;                    // Tamanyo actual del buffer.
+  char* buffer;               // Contenido de la linea, con el hueco en medio.
+  int capacidad;              // Tamanyo reservado para el buffer.
+  int hueco;                  // Posicion del hueco dentro del contenido.
+  int len;                    // Tamanyo actual del contenido.
   int cursor;                 // Posicion del cursor.
   struct
   {
     char bytes [ 32 ];        // Secuencia de escape en proceso.
     int len;                  // Tamanyo en bytes de la secuencia de escape.
+    int procesados;           // Bytes ya consumidos por el decodificador.
+    int estado;               // Estado del decodificador tras los bytes procesados.
   } escape;
+  Lexico lexico;              // Tokens del contenido, al día con cada cambio.
 } Linea;
 
 void linea_inicializar ( Linea* linea );
-void linea_anyadir ( Linea* linea, char c, void (*fnMostrar)(char) );
-void linea_anyadir_secuencia_escape ( Linea* linea, char c, void (*fnMostrar)(char) );
-void linea_mostrar_secuencia_escape ( Linea* linea, void (*fnMostrar)(char) );
+void linea_vaciar ( Linea* linea );
+void linea_liberar ( Linea* linea );
+void linea_anyadir ( Linea* linea, char c );
+void linea_insertar ( Linea* linea, const char* texto, int n );
+void linea_anyadir_secuencia_escape ( Linea* linea, char c );
 void linea_limpiar_secuencia_escape ( Linea* linea );
-int linea_procesar_secuencia_escape ( Linea* linea, CodigoSecuencia codigo );
-void linea_mostrar_intervalo ( Linea* linea, int inicio, int n );
-void linea_mostrar_desde_cursor ( Linea* linea );
+void linea_procesar_secuencia_escape ( Linea* linea, CodigoSecuencia codigo );
 void linea_cargar_contenido ( Linea* linea, char* contenido );
 void linea_mostrar_reset ( Linea* linea );
 void linea_backspace ( Linea* linea );
 void linea_suprimir ( Linea* linea );
 void linea_eliminar_desde_cursor ( Linea* linea );
 char* linea_hacer_string ( Linea* linea );
+char linea_caracter ( Linea* linea, int posicion );
+void linea_copiar ( Linea* linea, int inicio, int fin, char* destino );
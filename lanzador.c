@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       lanzador.c
+ * DESCRIPCIÓN:   Lanzamiento de programas con posix_spawn.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "eventos.h"
+#include "io.h"
+#include "lanzador.h"
+#include "rutas.h"
+#include "trabajos.h"
+
+extern char** environ;
+
+static int flags_fichero_salida ( const Redirecciones* redirecciones )
+{
+  int flags = O_WRONLY | O_CREAT;
+
+  if ( redirecciones->salidaAgregada )
+    flags |= O_APPEND;
+  else
+    flags |= O_TRUNC;
+
+  return flags;
+}
+
+pid_t lanzador_ejecutar ( char* argv[], const Redirecciones* redirecciones, pid_t grupo )
+{
+  posix_spawn_file_actions_t acciones;
+  posix_spawnattr_t atributos;
+  sigset_t mascara;
+  sigset_t ignoradas;
+  short flags = 0;
+  Rutas* rutas = rutas_obtener_instancia ();
+  const char* ruta;
+  pid_t pid;
+  int error;
+
+  // Buscamos el programa en la caché de rutas en lugar de dejar que
+  // posix_spawnp recorra el PATH en cada ejecución.
+  ruta = rutas_buscar ( rutas, argv[0] );
+  if ( ruta == NULL )
+  {
+    writef ( 2, "%s: comando no encontrado\n", argv[0] );
+    return -1;
+  }
+
+  // Las redirecciones se hacen en el hijo mediante acciones, en el mismo
+  // orden en el que las haríamos tras un fork. Los pipes se crean con
+  // O_CLOEXEC, así que basta con duplicar los extremos de este programa: el
+  // resto se cierran solos al ejecutarlo.
+  posix_spawn_file_actions_init ( &acciones );
+  if ( redirecciones->entrada != -1 )
+    posix_spawn_file_actions_adddup2 ( &acciones, redirecciones->entrada, 0 );
+  if ( redirecciones->salida != -1 )
+    posix_spawn_file_actions_adddup2 ( &acciones, redirecciones->salida, 1 );
+  if ( redirecciones->ficheroSalida != NULL )
+  {
+    posix_spawn_file_actions_addopen ( &acciones, 1, redirecciones->ficheroSalida,
+                                       flags_fichero_salida ( redirecciones ), S_IREAD | S_IWRITE );
+  }
+
+  // El programa no debe heredar las señales bloqueadas ni las ignoradas por el shell.
+  posix_spawnattr_init ( &atributos );
+  if ( eventos_mascara_original ( &mascara ) )
+  {
+    posix_spawnattr_setsigmask ( &atributos, &mascara );
+    flags |= POSIX_SPAWN_SETSIGMASK;
+  }
+  if ( trabajos_senyales_ignoradas ( &ignoradas ) )
+  {
+    posix_spawnattr_setsigdefault ( &atributos, &ignoradas );
+    flags |= POSIX_SPAWN_SETSIGDEF;
+  }
+
+  // Con control de trabajos, cada trabajo va en su propio grupo de procesos.
+  if ( grupo != -1 )
+  {
+    posix_spawnattr_setpgroup ( &atributos, grupo );
+    flags |= POSIX_SPAWN_SETPGROUP;
+  }
+  posix_spawnattr_setflags ( &atributos, flags );
+
+  error = posix_spawn ( &pid, ruta, &acciones, &atributos, argv, environ );
+  if ( ( error == ENOENT ) && ( ruta != argv[0] ) )
+  {
+    // El programa ha desaparecido desde que lo guardamos: lo volvemos a buscar.
+    rutas_olvidar ( rutas, argv[0] );
+    ruta = rutas_buscar ( rutas, argv[0] );
+    if ( ruta != NULL )
+      error = posix_spawn ( &pid, ruta, &acciones, &atributos, argv, environ );
+  }
+
+  posix_spawnattr_destroy ( &atributos );
+  posix_spawn_file_actions_destroy ( &acciones );
+
+  if ( ruta == NULL )
+  {
+    writef ( 2, "%s: comando no encontrado\n", argv[0] );
+    return -1;
+  }
+
+  if ( error != 0 )
+  {
+    writef ( 2, "%s: %s\n", argv[0], strerror ( error ) );
+    return -1;
+  }
+
+  return pid;
+}
+
+int lanzador_redirigir ( const Redirecciones* redirecciones )
+{
+  if ( redirecciones->entrada != -1 )
+  {
+    if ( ( dup2 ( redirecciones->entrada, 0 ) == -1 ) || ( close ( redirecciones->entrada ) == -1 ) )
+    {
+      perror ( "dup2" );
+      return -1;
+    }
+  }
+  if ( redirecciones->salida != -1 )
+  {
+    if ( ( dup2 ( redirecciones->salida, 1 ) == -1 ) || ( close ( redirecciones->salida ) == -1 ) )
+    {
+      perror ( "dup2" );
+      return -1;
+    }
+  }
+  if ( redirecciones->cerrar != -1 )
+  {
+    close ( redirecciones->cerrar );
+  }
+  if ( redirecciones->ficheroSalida != NULL )
+  {
+    int fd = open ( redirecciones->ficheroSalida, flags_fichero_salida ( redirecciones ), S_IREAD | S_IWRITE );
+    if ( fd == -1 )
+    {
+      perror ( "open" );
+      return -1;
+    }
+    if ( fd != 1 )
+    {
+      dup2 ( fd, 1 );
+      close ( fd );
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       lanzador.h
+ * DESCRIPCIÓN:   Lanzamiento de programas con posix_spawn.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+// Redirecciones de la entrada y salida estándar de un programa.
+typedef struct
+{
+  int entrada;                  // Descriptor a usar como entrada estándar, o -1.
+  int salida;                   // Descriptor a usar como salida estándar, o -1.
+  int cerrar;                   // Descriptor a cerrar en los hijos creados con fork, o -1.
+  const char* ficheroSalida;    // Fichero al que redirigir la salida estándar, o NULL.
+  int salidaAgregada;           // ¿Agregar al fichero en lugar de truncarlo?
+} Redirecciones;
+
+// Lanza un programa externo sin duplicar el espacio de memoria del shell.
+// El hijo se pone en el grupo de procesos indicado (0 para crear uno nuevo, -1
+// para no cambiarlo). Devuelve el pid del hijo, o -1 tras informar del error.
+pid_t lanzador_ejecutar ( char* argv[], const Redirecciones* redirecciones, pid_t grupo );
+
+// Aplica las redirecciones en el proceso actual. Para los hijos creados con
+// fork, como los que ejecutan comandos internos en un pipe.
+int lanzador_redirigir ( const Redirecciones* redirecciones );
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       latencia.c
+ * DESCRIPCIÓN:   Medida de la latencia entre la entrada y su reflejo en pantalla.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <string.h>
+#include <time.h>
+#include "io.h"
+#include "latencia.h"
+
+// Histograma logarítmico al estilo de HdrHistogram: los valores pequeños se
+// guardan exactos, y a partir de ahí cada potencia de dos se divide en
+// LATENCIA_SUBDIVISIONES cubos, con un error relativo por debajo del 6.25%.
+#define LATENCIA_BITS               5
+#define LATENCIA_DIRECTOS           ( 1 << LATENCIA_BITS )
+#define LATENCIA_SUBDIVISIONES      ( 1 << ( LATENCIA_BITS - 1 ) )
+#define LATENCIA_DESPLAZAMIENTOS    36      // Hasta 2^41 ns, unos 36 minutos.
+#define LATENCIA_CUBOS              ( LATENCIA_DIRECTOS + LATENCIA_DESPLAZAMIENTOS * LATENCIA_SUBDIVISIONES )
+
+typedef struct
+{
+  unsigned int cubos [ LATENCIA_CUBOS ];
+  unsigned int total;
+  long long maximo;
+} Histograma;
+
+static const char* nombresClases [ LATENCIA_MAXIMA ] = {
+  "insercion",
+  "borrado",
+  "sugerencias",
+  "historial",
+  "escape"
+};
+
+static Histograma histogramas [ LATENCIA_MAXIMA ];
+static struct timespec latencia_entrada;
+static ClaseLatencia latencia_clase = LATENCIA_NINGUNA;
+
+static int cubo_para_valor ( long long valor )
+{
+  int desplazamiento = 0;
+
+  if ( valor < LATENCIA_DIRECTOS )
+    return (int)valor;
+
+  // Nos quedamos con los LATENCIA_BITS bits más significativos. El más alto
+  // siempre vale 1, así que los siguientes eligen el cubo dentro de la potencia.
+  while ( ( valor >> desplazamiento ) >= LATENCIA_DIRECTOS )
+    ++desplazamiento;
+
+  if ( desplazamiento > LATENCIA_DESPLAZAMIENTOS )
+    return LATENCIA_CUBOS - 1;
+
+  return LATENCIA_DIRECTOS + ( desplazamiento - 1 ) * LATENCIA_SUBDIVISIONES +
+         (int)( ( valor >> desplazamiento ) - LATENCIA_SUBDIVISIONES );
+}
+
+static long long valor_para_cubo ( int cubo )
+{
+  int desplazamiento;
+  int sub;
+
+  if ( cubo < LATENCIA_DIRECTOS )
+    return cubo;
+
+  // Límite superior del cubo.
+  desplazamiento = ( cubo - LATENCIA_DIRECTOS ) / LATENCIA_SUBDIVISIONES + 1;
+  sub = ( cubo - LATENCIA_DIRECTOS ) % LATENCIA_SUBDIVISIONES;
+  return ( (long long)( LATENCIA_SUBDIVISIONES + sub + 1 ) << desplazamiento ) - 1;
+}
+
+void latencia_marcar_entrada ()
+{
+  clock_gettime ( CLOCK_MONOTONIC, &latencia_entrada );
+}
+
+void latencia_clasificar ( ClaseLatencia clase )
+{
+  latencia_clase = clase;
+}
+
+void latencia_registrar ()
+{
+  struct timespec ahora;
+  long long transcurrido;
+  Histograma* histograma;
+
+  if ( latencia_clase == LATENCIA_NINGUNA )
+    return;
+
+  clock_gettime ( CLOCK_MONOTONIC, &ahora );
+  transcurrido = ( ahora.tv_sec - latencia_entrada.tv_sec ) * 1000000000LL +
+                 ( ahora.tv_nsec - latencia_entrada.tv_nsec );
+  if ( transcurrido < 0 )
+    transcurrido = 0;
+
+  histograma = &(histogramas [ latencia_clase ]);
+  histograma->cubos [ cubo_para_valor ( transcurrido ) ]++;
+  histograma->total++;
+  if ( transcurrido > histograma->maximo )
+    histograma->maximo = transcurrido;
+
+  latencia_clase = LATENCIA_NINGUNA;
+}
+
+static long long percentil ( Histograma* histograma, int porMil )
+{
+  // Buscamos el primer cubo en el que la cuenta acumulada alcanza el percentil.
+  unsigned long long objetivo = ( (unsigned long long)histograma->total * porMil + 999 ) / 1000;
+  unsigned long long acumulado = 0;
+  long long valor;
+  int i;
+
+  if ( objetivo == 0 )
+    objetivo = 1;
+
+  for ( i = 0; i < LATENCIA_CUBOS; ++i )
+  {
+    acumulado += histograma->cubos [ i ];
+    if ( acumulado >= objetivo )
+    {
+      valor = valor_para_cubo ( i );
+      return ( valor < histograma->maximo ) ? valor : histograma->maximo;
+    }
+  }
+
+  return histograma->maximo;
+}
+
+void latencia_mostrar ( int fd )
+{
+  int i;
+
+  writef ( fd, "%-12s %9s %10s %10s %10s %10s\n", "clase", "eventos", "p50(us)", "p90(us)", "p99(us)", "max(us)" );
+  for ( i = 0; i < LATENCIA_MAXIMA; ++i )
+  {
+    Histograma* histograma = &(histogramas [ i ]);
+
+    if ( histograma->total == 0 )
+    {
+      writef ( fd, "%-12s %9u %10s %10s %10s %10s\n", nombresClases [ i ], 0, "-", "-", "-", "-" );
+    }
+    else
+    {
+      writef ( fd, "%-12s %9u %10.1f %10.1f %10.1f %10.1f\n", nombresClases [ i ], histograma->total,
+               percentil ( histograma, 500 ) / 1000.0,
+               percentil ( histograma, 900 ) / 1000.0,
+               percentil ( histograma, 990 ) / 1000.0,
+               histograma->maximo / 1000.0 );
+    }
+  }
+}
+
+void latencia_reiniciar ()
+{
+  memset ( histogramas, 0, sizeof(histogramas) );
+}
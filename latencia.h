@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       latencia.h
+ * DESCRIPCIÓN:   Medida de la latencia entre la entrada y su reflejo en pantalla.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#pragma once
+
+typedef enum
+{
+  LATENCIA_NINGUNA = -1,      // El evento no se mide.
+  LATENCIA_INSERCION = 0,
+  LATENCIA_BORRADO,
+  LATENCIA_SUGERENCIAS,
+  LATENCIA_HISTORIAL,
+  LATENCIA_ESCAPE,
+
+  LATENCIA_MAXIMA             // Marcador del número de clases. NO MODIFICAR.
+} ClaseLatencia;
+
+// El bucle principal marca cuándo llega la entrada, el procesado de cada tecla
+// indica de qué clase es el evento, y al terminar de enviar la salida se
+// registra el tiempo transcurrido.
+void latencia_marcar_entrada ();
+void latencia_clasificar ( ClaseLatencia clase );
+void latencia_registrar ();
+
+// Muestra los percentiles de cada clase y reinicia las medidas.
+void latencia_mostrar ( int fd );
+void latencia_reiniciar ();
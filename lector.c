@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       lector.c
+ * DESCRIPCIÓN:   Lectura de lineas por bloques para el modo no interactivo.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "cadena.h"
+#include "config.h"
+#include "lector.h"
+
+struct LectorLineas_
+{
+  int fd;
+  int fin;                                    // ¿Hemos llegado al final de la entrada?
+  char buffer [ TAMANYO_BUFFER_LECTOR ];
+  int inicio;                                 // Posición del siguiente caracter a procesar.
+  int len;                                    // Bytes válidos en el buffer.
+  Cadena linea;                               // Linea devuelta en la última llamada.
+};
+
+LectorLineas* lector_crear ( int fd )
+{
+  LectorLineas* lector = (LectorLineas *)malloc ( sizeof(LectorLineas) );
+  memset ( lector, 0, sizeof(LectorLineas) );
+  lector->fd = fd;
+  cadena_inicializar ( &(lector->linea) );
+  return lector;
+}
+
+void lector_liberar ( LectorLineas* lector )
+{
+  cadena_liberar ( &(lector->linea) );
+  free ( lector );
+}
+
+static int lector_rellenar ( LectorLineas* lector )
+{
+  int n;
+
+  do
+  {
+    n = read ( lector->fd, lector->buffer, TAMANYO_BUFFER_LECTOR );
+  } while ( ( n == -1 ) && ( errno == EINTR ) );
+
+  lector->inicio = 0;
+  lector->len = ( n > 0 ) ? n : 0;
+  if ( n <= 0 )
+    lector->fin = 1;
+
+  return n;
+}
+
+char* lector_leer_linea ( LectorLineas* lector )
+{
+  char* salto;
+  int n;
+
+  cadena_vaciar ( &(lector->linea) );
+
+  while ( 1 )
+  {
+    if ( lector->inicio == lector->len )
+    {
+      if ( lector->fin || ( lector_rellenar ( lector ) <= 0 ) )
+      {
+        // La última linea puede no acabar en salto de linea.
+        if ( lector->linea.len > 0 )
+          break;
+        return NULL;
+      }
+    }
+
+    // Copiamos hasta el salto de linea o hasta el final de lo leído.
+    n = lector->len - lector->inicio;
+    salto = (char *)memchr ( &(lector->buffer [ lector->inicio ]), '\n', n );
+    if ( salto != NULL )
+      n = salto - &(lector->buffer [ lector->inicio ]);
+
+    cadena_anyadir_n ( &(lector->linea), &(lector->buffer [ lector->inicio ]), n );
+    lector->inicio += n;
+
+    if ( salto != NULL )
+    {
+      lector->inicio++;
+      break;
+    }
+  }
+
+  // Descartamos el retorno de carro de los ficheros con saltos de linea de DOS.
+  if ( ( lector->linea.len > 0 ) && ( lector->linea.datos [ lector->linea.len - 1 ] == '\r' ) )
+  {
+    lector->linea.len--;
+    lector->linea.datos [ lector->linea.len ] = '\0';
+  }
+
+  return lector->linea.datos;
+}
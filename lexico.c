@@ -0,0 +1,400 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       lexico.c
+ * DESCRIPCIÓN:   Análisis léxico incremental de la linea en edición.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "io.h"
+#include "lexico.h"
+
+#define LEXICO_COMILLAS ( LEXICO_COMILLA_SIMPLE | LEXICO_COMILLA_DOBLE )
+#define LEXICO_ESTADO_INICIAL LEXICO_COMANDO
+
+#define TOKEN_TRAS_HUECO(lexico) ( &((lexico)->tokens [ (lexico)->capacidad - (lexico)->despues ]) )
+
+static int es_blanco ( char c )
+{
+  return ( c == ' ' ) || ( c == '\t' ) || ( c == '\n' );
+}
+
+static int es_operador ( char c )
+{
+  return ( c == '|' ) || ( c == '&' ) || ( c == ';' ) || ( c == '<' ) || ( c == '>' );
+}
+
+static int es_de_palabra ( const Token* token )
+{
+  return ( token != NULL ) && ( ( token->tipo == TOKEN_PALABRA ) || ( token->tipo == TOKEN_CADENA ) );
+}
+
+static char caracter ( Linea* linea, int posicion )
+{
+  return ( posicion < linea->len ) ? linea_caracter ( linea, posicion ) : '\0';
+}
+
+void lexico_inicializar ( Lexico* lexico )
+{
+  memset ( lexico, 0, sizeof(Lexico) );
+  lexico->estadoFinal = LEXICO_ESTADO_INICIAL;
+}
+
+void lexico_vaciar ( Lexico* lexico )
+{
+  lexico->antes = 0;
+  lexico->despues = 0;
+  lexico->posicion = 0;
+  lexico->estadoFinal = LEXICO_ESTADO_INICIAL;
+}
+
+void lexico_liberar ( Lexico* lexico )
+{
+  free ( lexico->tokens );
+  lexico_inicializar ( lexico );
+}
+
+// Lleva el hueco hasta el token que contiene la posición.
+static void mover_hueco ( Lexico* lexico, int posicion )
+{
+  while ( ( lexico->antes > 0 ) && ( lexico->posicion > posicion ) )
+  {
+    Token* token = &(lexico->tokens [ --lexico->antes ]);
+    lexico->despues++;
+    lexico->posicion -= token->len;
+    *TOKEN_TRAS_HUECO ( lexico ) = *token;
+  }
+
+  while ( ( lexico->despues > 0 ) && ( lexico->posicion + TOKEN_TRAS_HUECO ( lexico )->len <= posicion ) )
+  {
+    Token* token = TOKEN_TRAS_HUECO ( lexico );
+    lexico->despues--;
+    lexico->posicion += token->len;
+    lexico->tokens [ lexico->antes++ ] = *token;
+  }
+}
+
+static void anyadir_token ( Lexico* lexico, const Token* token )
+{
+  if ( lexico->antes + lexico->despues == lexico->capacidad )
+  {
+    int capacidad = ( lexico->capacidad == 0 ) ? 16 : ( lexico->capacidad * 2 );
+
+    lexico->tokens = (Token *)realloc ( lexico->tokens, sizeof(Token) * capacidad );
+    memmove ( &(lexico->tokens [ capacidad - lexico->despues ]), &(lexico->tokens [ lexico->capacidad - lexico->despues ]),
+              sizeof(Token) * lexico->despues );
+    lexico->capacidad = capacidad;
+  }
+
+  lexico->tokens [ lexico->antes++ ] = *token;
+}
+
+// Al terminar una palabra, el comando deja de esperar el nombre del programa
+// o el destino de la redirección, según lo que fuese.
+static unsigned char fin_de_palabra ( unsigned char estado )
+{
+  if ( estado & LEXICO_PALABRA )
+  {
+    if ( estado & LEXICO_DESTINO )
+      estado &= ~LEXICO_DESTINO;
+    else
+      estado &= ~LEXICO_COMANDO;
+  }
+  return estado & ~LEXICO_PALABRA;
+}
+
+// Lee el texto de unas comillas, hasta cerrarlas o hasta el máximo.
+static int leer_cadena ( Linea* linea, int p, int maximo, unsigned char* estado )
+{
+  char comilla = ( *estado & LEXICO_COMILLA_SIMPLE ) ? '\'' : '"';
+
+  while ( p < maximo )
+  {
+    char c = caracter ( linea, p );
+
+    if ( c == comilla )
+    {
+      *estado &= ~LEXICO_COMILLAS;
+      return p + 1;
+    }
+
+    // Un token nunca se parte tras un \, así que no hace falta recordarlo.
+    if ( ( comilla == '"' ) && ( c == '\\' ) && ( p + 1 < linea->len ) )
+      p += 2;
+    else
+      ++p;
+  }
+
+  return p;
+}
+
+static int leer_operador ( Linea* linea, int p, unsigned char* estado )
+{
+  char c = caracter ( linea, p );
+  char c2 = caracter ( linea, p + 1 );
+  int redireccion = ( c == '<' ) || ( c == '>' );
+
+  if ( ( ( c == '|' ) || ( c == '&' ) || ( c == '>' ) ) && ( c2 == c ) )
+    p += 2;
+  else if ( ( c == '<' ) && ( c2 == '<' ) )
+    p += ( ( caracter ( linea, p + 2 ) == '<' ) || ( caracter ( linea, p + 2 ) == '-' ) ) ? 3 : 2;
+  else
+    ++p;
+
+  // Tras una redirección viene su destino, y tras el resto, otro comando.
+  if ( redireccion )
+    *estado |= LEXICO_DESTINO;
+  else
+    *estado = ( *estado | LEXICO_COMANDO ) & ~LEXICO_DESTINO;
+
+  return p;
+}
+
+// Lee un token desde la posición, con el estado dado, y deja en el estado el
+// del siguiente token. Los tokens de texto no pasan del límite, para poder
+// aprovechar a partir de él los tokens que ya había.
+static void leer_token ( Linea* linea, int posicion, int limite, Token* token, unsigned char* estado )
+{
+  int maximo = posicion + LEXICO_TAMANYO_MAXIMO_TOKEN;
+  char c = caracter ( linea, posicion );
+  int p = posicion;
+
+  if ( ( limite > posicion ) && ( limite < maximo ) )
+    maximo = limite;
+  if ( maximo > linea->len )
+    maximo = linea->len;
+
+  token->estado = *estado;
+  token->marca = 0;
+
+  if ( *estado & LEXICO_COMENTARIO )
+  {
+    token->tipo = TOKEN_COMENTARIO;
+    p = maximo;
+  }
+  else if ( *estado & LEXICO_COMILLAS )
+  {
+    token->tipo = TOKEN_CADENA;
+    p = leer_cadena ( linea, p, maximo, estado );
+  }
+  else if ( es_blanco ( c ) )
+  {
+    token->tipo = TOKEN_BLANCO;
+    while ( ( p < maximo ) && es_blanco ( caracter ( linea, p ) ) )
+      ++p;
+    *estado = fin_de_palabra ( *estado );
+  }
+  else if ( es_operador ( c ) )
+  {
+    token->tipo = TOKEN_OPERADOR;
+    *estado = fin_de_palabra ( *estado );
+    p = leer_operador ( linea, p, estado );
+  }
+  else if ( ( c == '#' ) && !( *estado & LEXICO_PALABRA ) )
+  {
+    // Un # al comienzo de una palabra comenta el resto de la linea.
+    token->tipo = TOKEN_COMENTARIO;
+    *estado |= LEXICO_COMENTARIO;
+    p = maximo;
+  }
+  else if ( ( c == '\'' ) || ( c == '"' ) )
+  {
+    token->tipo = TOKEN_CADENA;
+    *estado |= LEXICO_PALABRA | ( ( c == '\'' ) ? LEXICO_COMILLA_SIMPLE : LEXICO_COMILLA_DOBLE );
+    p = leer_cadena ( linea, p + 1, maximo, estado );
+  }
+  else
+  {
+    token->tipo = TOKEN_PALABRA;
+    *estado |= LEXICO_PALABRA;
+    while ( p < maximo )
+    {
+      c = caracter ( linea, p );
+      if ( es_blanco ( c ) || es_operador ( c ) || ( c == '\'' ) || ( c == '"' ) )
+        break;
+      p += ( ( c == '\\' ) && ( p + 1 < linea->len ) ) ? 2 : 1;
+    }
+  }
+
+  token->len = p - posicion;
+}
+
+void lexico_actualizar ( Lexico* lexico, Linea* linea, int posicion, int borrados, int insertados )
+{
+  int desplazamiento = insertados - borrados;
+  int finCambio = posicion + borrados;
+  int inicioViejo;
+  int actual;
+  unsigned char estado;
+  int i;
+
+  // El primer token afectado es el que contiene el caracter anterior al
+  // cambio, ya que dónde termina depende del caracter que le sigue.
+  mover_hueco ( lexico, ( posicion > 0 ) ? ( posicion - 1 ) : 0 );
+  estado = ( lexico->despues > 0 ) ? TOKEN_TRAS_HUECO ( lexico )->estado : lexico->estadoFinal;
+
+  // Si el cambio cae dentro de una palabra, lo que se sepa de ella deja de valer.
+  if ( ( lexico->despues > 0 ) && lexico_token_continua_palabra ( TOKEN_TRAS_HUECO ( lexico ) ) )
+  {
+    for ( i = lexico->antes - 1; i >= 0; --i )
+    {
+      lexico->tokens[i].marca = 0;
+      if ( !lexico_token_continua_palabra ( &(lexico->tokens[i]) ) )
+        break;
+    }
+  }
+
+  // Los tokens antiguos tras el hueco se van descartando según los nuevos
+  // los cubren. inicioViejo es dónde empieza el primero en la linea antigua.
+  actual = lexico->posicion;
+  inicioViejo = lexico->posicion;
+  for ( ;; )
+  {
+    Token token;
+    int limite = -1;
+
+    while ( lexico->despues > 0 )
+    {
+      if ( ( inicioViejo >= finCambio ) && ( inicioViejo + desplazamiento >= actual ) )
+        break;
+      inicioViejo += TOKEN_TRAS_HUECO ( lexico )->len;
+      lexico->despues--;
+    }
+
+    if ( lexico->despues > 0 )
+    {
+      // Si llegamos a un token antiguo en el mismo estado, el resto no cambia.
+      if ( ( inicioViejo + desplazamiento == actual ) && ( TOKEN_TRAS_HUECO ( lexico )->estado == estado ) )
+        break;
+      limite = inicioViejo + desplazamiento;
+    }
+    else if ( actual >= linea->len )
+    {
+      lexico->estadoFinal = estado;
+      break;
+    }
+
+    leer_token ( linea, actual, limite, &token, &estado );
+    anyadir_token ( lexico, &token );
+    actual += token.len;
+  }
+
+  lexico->posicion = actual;
+}
+
+Token* lexico_token ( Lexico* lexico, int posicion, int* inicio )
+{
+  mover_hueco ( lexico, posicion );
+  if ( lexico->despues == 0 )
+    return NULL;
+
+  if ( inicio )
+    *inicio = lexico->posicion;
+  return TOKEN_TRAS_HUECO ( lexico );
+}
+
+
+int lexico_palabra ( Lexico* lexico, int posicion, int* inicio, int* fin, int* esComando )
+{
+  Token* token = lexico_token ( lexico, posicion, NULL );
+  int i;
+
+  if ( !es_de_palabra ( token ) && ( posicion > 0 ) )
+    token = lexico_token ( lexico, posicion - 1, NULL );
+  if ( !es_de_palabra ( token ) )
+    return 0;
+
+  // Con el hueco en el token, la palabra se extiende hacia atrás y hacia
+  // delante por los tokens que la continúan.
+  *inicio = lexico->posicion;
+  for ( i = lexico->antes; ( i > 0 ) && lexico_token_continua_palabra ( lexico_obtener ( lexico, i ) ); --i )
+    *inicio -= lexico_obtener ( lexico, i - 1 )->len;
+  *esComando = lexico_token_es_comando ( lexico_obtener ( lexico, i ) );
+
+  *fin = lexico->posicion + token->len;
+  for ( i = lexico->antes + 1; ( i < lexico_num_tokens ( lexico ) ) && lexico_token_continua_palabra ( lexico_obtener ( lexico, i ) ); ++i )
+    *fin += lexico_obtener ( lexico, i )->len;
+
+  return 1;
+}
+
+int lexico_es_comando ( Lexico* lexico, int posicion )
+{
+  Token* token = lexico_token ( lexico, posicion, NULL );
+  unsigned char estado;
+  int inicio;
+  int fin;
+  int esComando;
+
+  // Dentro de una palabra, lo que diga su comienzo.
+  if ( es_de_palabra ( token ) )
+  {
+    lexico_palabra ( lexico, posicion, &inicio, &fin, &esComando );
+    return esComando;
+  }
+
+  if ( token == NULL )
+    estado = lexico->estadoFinal;
+  else if ( token->tipo == TOKEN_COMENTARIO )
+    return 0;
+  else if ( token->tipo == TOKEN_BLANCO )
+    estado = fin_de_palabra ( token->estado );
+  else
+    estado = token->estado;
+
+  return ( ( estado & ( LEXICO_COMANDO | LEXICO_DESTINO | LEXICO_COMILLAS | LEXICO_COMENTARIO ) ) == LEXICO_COMANDO );
+}
+
+int lexico_num_tokens ( Lexico* lexico )
+{
+  return lexico->antes + lexico->despues;
+}
+
+Token* lexico_obtener ( Lexico* lexico, int indice )
+{
+  if ( indice < lexico->antes )
+    return &(lexico->tokens [ indice ]);
+  return &(lexico->tokens [ lexico->capacidad - lexico->despues + ( indice - lexico->antes ) ]);
+}
+
+int lexico_token_continua_palabra ( const Token* token )
+{
+  return es_de_palabra ( token ) && ( token->estado & LEXICO_PALABRA );
+}
+
+int lexico_token_es_comando ( const Token* token )
+{
+  return es_de_palabra ( token ) &&
+         ( ( token->estado & ( LEXICO_COMANDO | LEXICO_DESTINO ) ) == LEXICO_COMANDO );
+}
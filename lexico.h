@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       lexico.h
+ * DESCRIPCIÓN:   Análisis léxico incremental de la linea en edición.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#pragma once
+
+struct _Linea;
+
+typedef enum
+{
+  TOKEN_BLANCO,
+  TOKEN_PALABRA,                // Texto sin comillas de una palabra.
+  TOKEN_CADENA,                 // Texto entre comillas, incluidas éstas.
+  TOKEN_OPERADOR,               // | || & && ; < << <<- <<< > >>
+  TOKEN_COMENTARIO
+} TipoToken;
+
+// Estado del análisis al comienzo de cada token.
+#define LEXICO_COMILLA_SIMPLE   0x01    // Dentro de '...' sin cerrar.
+#define LEXICO_COMILLA_DOBLE    0x02    // Dentro de "..." sin cerrar.
+#define LEXICO_COMENTARIO       0x04
+#define LEXICO_PALABRA          0x08    // La palabra del token anterior aún no ha terminado.
+#define LEXICO_COMANDO          0x10    // El comando aún no tiene nombre de programa, o es la palabra en curso.
+#define LEXICO_DESTINO          0x20    // La palabra en curso es el destino de una redirección.
+
+typedef struct
+{
+  unsigned short len;
+  unsigned char tipo;
+  unsigned char estado;
+  unsigned char marca;          // Para uso de quien recorre los tokens. Vale 0 en los tokens nuevos.
+} Token;
+
+// Tokens de la linea. Como el contenido de la linea, se guardan en un vector
+// con un hueco en el punto de edición, y de cada token sólo se guarda su
+// tamaño: al editar no hay que desplazar ni renumerar los demás.
+typedef struct
+{
+  Token* tokens;
+  int capacidad;
+  int antes;                    // Tokens antes del hueco.
+  int despues;                  // Tokens tras el hueco, al final del vector.
+  int posicion;                 // Posición en la linea del final de los tokens antes del hueco.
+  unsigned char estadoFinal;    // Estado tras el último token.
+} Lexico;
+
+void lexico_inicializar ( Lexico* lexico );
+void lexico_vaciar ( Lexico* lexico );
+void lexico_liberar ( Lexico* lexico );
+
+// Actualiza los tokens cuando en la linea se han sustituido `borrados`
+// caracteres desde la posición por `insertados` nuevos. Se analiza desde el
+// token anterior al cambio hasta llegar a un token antiguo que empiece en el
+// mismo estado, a partir del cual ya no cambia nada. Los tokens largos se
+// parten en trozos, así que al escribir el coste no depende del tamaño de la
+// linea.
+void lexico_actualizar ( Lexico* lexico, struct _Linea* linea, int posicion, int borrados, int insertados );
+
+// Token que contiene la posición, o NULL si está al final de la linea. Cerca
+// del último punto de edición no hace falta recorrer los demás tokens.
+Token* lexico_token ( Lexico* lexico, int posicion, int* inicio );
+
+// Palabra que contiene la posición o termina justo antes de ella. Devuelve 0
+// si no hay ninguna. esComando indica si es el nombre del programa.
+int lexico_palabra ( Lexico* lexico, int posicion, int* inicio, int* fin, int* esComando );
+
+// ¿Sería el nombre de un programa una palabra que empezase en la posición?
+int lexico_es_comando ( Lexico* lexico, int posicion );
+
+// Acceso a los tokens en orden, para recorrerlos todos.
+int lexico_num_tokens ( Lexico* lexico );
+Token* lexico_obtener ( Lexico* lexico, int indice );
+
+// ¿Es el token la continuación de la palabra del anterior?
+int lexico_token_continua_palabra ( const Token* token );
+
+// ¿Comienza en el token el nombre de un programa?
+int lexico_token_es_comando ( const Token* token );
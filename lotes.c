@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       lotes.c
+ * DESCRIPCIÓN:   Ejecución por lotes de programas con demasiados argumentos.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "config.h"
+#include "eventos.h"
+#include "io.h"
+#include "lotes.h"
+#include "trabajos.h"
+
+extern char** environ;
+
+static int lotes_activo = 0;
+
+void lotes_activar ( int activar )
+{
+  lotes_activo = activar;
+}
+
+int lotes_activados ()
+{
+  return lotes_activo;
+}
+
+// Lo que ocupa un argumento al ejecutar un programa: el texto y su puntero.
+static size_t tamanyo_argumento ( const char* argumento )
+{
+  return strlen ( argumento ) + 1 + sizeof(char *);
+}
+
+// Espacio disponible para los argumentos: el límite del sistema menos el
+// entorno, que se pasa con ellos, y un margen como el que deja xargs.
+static size_t limite_argumentos ()
+{
+  long maximo = sysconf ( _SC_ARG_MAX );
+  size_t ocupado = LOTES_MARGEN_ARGUMENTOS;
+  char** p;
+
+  if ( maximo <= 0 )
+    maximo = _POSIX_ARG_MAX;
+  for ( p = environ; *p != NULL; ++p )
+    ocupado += tamanyo_argumento ( *p );
+
+  return ( (size_t)maximo > ocupado ) ? ( maximo - ocupado ) : 0;
+}
+
+int lotes_necesarios ( char* argv[], int argc )
+{
+  size_t limite = limite_argumentos ();
+  size_t tamanyo = sizeof(char *);
+  int i;
+
+  for ( i = 0; i < argc; ++i )
+  {
+    tamanyo += tamanyo_argumento ( argv[i] );
+    if ( tamanyo > limite )
+      return 1;
+  }
+  return 0;
+}
+
+static int ejecutar_lotes ( char* argv[], int argc, int inicio, int num )
+{
+  Redirecciones ninguna = { -1, -1, -1, NULL, 0 };
+  char** lote = (char **)malloc ( sizeof(char *) * ( argc + 1 ) );
+  size_t limite = limite_argumentos ();
+  size_t fijos = sizeof(char *);
+  int siguiente = inicio;
+  int codigo = 0;
+  int i;
+
+  for ( i = 0; i < argc; ++i )
+  {
+    if ( ( i < inicio ) || ( i >= inicio + num ) )
+      fijos += tamanyo_argumento ( argv[i] );
+  }
+
+  while ( siguiente < inicio + num )
+  {
+    size_t tamanyo = fijos;
+    int estado;
+    pid_t pid;
+    int n = 0;
+
+    // Cada lote lleva los argumentos fijos y tantos de los repartidos como
+    // quepan, al menos uno aunque no quepa.
+    for ( i = 0; i < inicio; ++i )
+      lote[n++] = argv[i];
+    do
+    {
+      tamanyo += tamanyo_argumento ( argv[siguiente] );
+      lote[n++] = argv[siguiente++];
+    } while ( ( siguiente < inicio + num ) && ( tamanyo + tamanyo_argumento ( argv[siguiente] ) <= limite ) );
+    for ( i = inicio + num; i < argc; ++i )
+      lote[n++] = argv[i];
+    lote[n] = NULL;
+
+    pid = lanzador_ejecutar ( lote, &ninguna, -1 );
+    if ( pid == -1 )
+    {
+      codigo = 127;
+      break;
+    }
+    while ( ( waitpid ( pid, &estado, 0 ) == -1 ) && ( errno == EINTR ) );
+    if ( codigo == 0 )
+      codigo = trabajos_codigo_salida ( estado );
+
+    // Si una ejecución muere por una señal, no se lanzan las siguientes.
+    if ( WIFSIGNALED ( estado ) )
+      break;
+  }
+
+  free ( lote );
+  return codigo;
+}
+
+pid_t lotes_ejecutar ( char* argv[], int argc, int inicio, int num,
+                       const Redirecciones* redirecciones, pid_t grupo )
+{
+  pid_t pid;
+
+  // Sin un comodín que repartir, se reparten todos los argumentos.
+  if ( ( num <= 0 ) || ( inicio < 1 ) || ( inicio + num > argc ) )
+  {
+    inicio = 1;
+    num = argc - 1;
+  }
+
+  pid = fork ();
+  switch ( pid )
+  {
+    case -1:
+      perror ( "fork" );
+      break;
+
+    case 0:
+      // Las ejecuciones van en el grupo de este hijo, de forma que el trabajo
+      // se controla como si fuese un único programa.
+      trabajos_restaurar_hijo ( grupo );
+      eventos_restaurar_hijo ();
+      if ( lanzador_redirigir ( redirecciones ) != 0 )
+        exit ( 1 );
+      exit ( ejecutar_lotes ( argv, argc, inicio, num ) );
+  }
+
+  return pid;
+}
+
+void lotes_mostrar ( int fd )
+{
+  writef ( fd, "autobatch: %s\n", lotes_activo ? "on" : "off" );
+  writef ( fd, "Límite para los argumentos: %lu bytes\n", (unsigned long)limite_argumentos () );
+}
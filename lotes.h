@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       lotes.h
+ * DESCRIPCIÓN:   Ejecución por lotes de programas con demasiados argumentos.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include "lanzador.h"
+
+// Cuando los argumentos de un programa no caben en el límite del sistema
+// (ARG_MAX), en lugar de fallar con E2BIG se puede ejecutar varias veces,
+// como haría xargs. Está desactivado por defecto.
+void lotes_activar ( int activar );
+int lotes_activados ();
+
+// ¿Superan los argumentos, junto con el entorno, el límite del sistema?
+int lotes_necesarios ( char* argv[], int argc );
+
+// Lanza un hijo del shell que ejecuta el programa varias veces, una tras otra,
+// repartiendo los argumentos [inicio, inicio + num) entre las ejecuciones y
+// repitiendo los demás en todas ellas. El hijo termina con el código de la
+// primera ejecución que falle. Devuelve su pid, o -1 tras informar del error.
+pid_t lotes_ejecutar ( char* argv[], int argc, int inicio, int num,
+                       const Redirecciones* redirecciones, pid_t grupo );
+
+// Muestra si está activado y el límite de tamaño de los argumentos.
+void lotes_mostrar ( int fd );
@@ -27,24 +27,33 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       main.c
- * DESCRIPCIN:   Punto de entrada y bucle de lectura.
+ * DESCRIPCIÓN:   Punto de entrada y bucle de lectura.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
+#include <fcntl.h>
 #include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include "aliases.h"
 #include "config.h"
 #include "comandos.h"
+#include "documentos.h"
+#include "eventos.h"
 #include "io.h"
+#include "latencia.h"
+#include "lector.h"
+#include "pantalla.h"
 #include "prompt.h"
+#include "sesion.h"
 #include "comodines.h"
 #include "terminal.h"
+#include "trabajos.h"
 #include "historial.h"
 #include "variables.h"
 
@@ -53,255 +62,597 @@ static Linea* linea;
 static Linea lineaActual;
 static Linea lineaHistorial;
 static int posicion_historial = -1;
+static Historial* hist;
+static Variables* vars;
+static Aliases* aliases;
+static char** entorno;
 
-static void sighandler ( int signum )
+// Linea que abrió los here-documents cuyos cuerpos se están leyendo, o NULL.
+static char* lineaDocumentos = NULL;
+static Documentos documentos;
+
+static void cancelar_documentos ()
+{
+  documentos_liberar ( &documentos );
+  free ( lineaDocumentos );
+  lineaDocumentos = NULL;
+  prompt_secundario ( 0 );
+}
+
+static int leer_documentos ( const char* texto )
+{
+  // Devuelve si aún faltan lineas para completar los here-documents.
+  if ( lineaDocumentos == NULL )
+  {
+    documentos_inicializar ( &documentos, texto );
+    if ( documentos_pendientes ( &documentos ) == 0 )
+      return 0;
+    lineaDocumentos = strdup ( texto );
+  }
+  else
+  {
+    documentos_anyadir_linea ( &documentos, texto );
+  }
+
+  prompt_secundario ( documentos_pendientes ( &documentos ) > 0 );
+  return documentos_pendientes ( &documentos ) > 0;
+}
+
+static void ejecutar_linea_interactiva ( char* texto )
+{
+  SesionTerminal* sesion = sesion_obtener_instancia ();
+
+  if ( lineaDocumentos != NULL )
+    texto = lineaDocumentos;
+
+  // Procesamos el comando introducido, devolviendo al terminal sus parámetros
+  // originales mientras se ejecuta.
+  sesion_salir_modo_crudo ( sesion );
+  if ( procesar_comando ( texto, entorno, vars, aliases, &documentos ) == COMANDO_SALIR )
+    continuar = 0;
+  cancelar_documentos ();
+
+  // Un CTRL+C dirigido al comando no debe afectar a la nueva linea, pero
+  // sí dejamos el prompt en una linea nueva.
+  if ( eventos_descartar_senyal ( SIGINT ) > 0 )
+    salida_escribir ( "\n", 1 );
+
+  // Reiniciamos el acceso al historial.
+  linea = &lineaActual;
+  posicion_historial = -1;
+  linea_vaciar ( linea );
+
+  if ( continuar )
+  {
+    // Avisamos de los trabajos en segundo plano que hayan terminado.
+    trabajos_notificar ( 1 );
+    sesion_entrar_modo_crudo ( sesion );
+    pantalla_mostrar_prompt ();
+  }
+}
+
+static void procesar_senyal ( int senyal )
 {
-  switch ( signum )
+  // Las señales llegan por el bucle de eventos, por lo que aquí podemos hacer
+  // cualquier trabajo sin riesgo de interrumpir al shell a medias.
+  switch ( senyal )
   {
     case SIGTERM:
       continuar = 0;
       break;
 
     case SIGINT:
-      writef ( 1, "\r\n" );
-      mostrar_prompt ();
-      linea_inicializar ( linea );
+      salida_escribir ( "\r\n", 2 );
+      cancelar_documentos ();
+      pantalla_mostrar_prompt ();
       linea = &lineaActual;
+      linea_vaciar ( linea );
       posicion_historial = -1;
       break;
+
+    case SIGCHLD:
+      trabajos_recoger ();
+      break;
+
+    case SIGWINCH:
+      // Con el nuevo tamaño la linea puede haberse recolocado: la redibujamos entera.
+      pantalla_invalidar ();
+      break;
   }
 }
 
-int main ( int argc, const char* argv[], char* envp[] )
+static void anyadir_caracter_pegado ( char** texto, int* len, int* capacidad, char c )
 {
-  linea = &lineaActual;
-
-  // Definido en historial.h
-  Historial* hist = historial_obtener_instancia ();
-
-  // Definido en variables.h
-  Variables* vars = variables_crear ();
-
-  // Definido en aliases.h
-  Aliases* aliases = aliases_obtener_instancia ();
+  // Los saltos de linea y tabuladores se convierten en espacios, y el resto de
+  // caracteres de control se descartan.
+  if ( ( c == '\n' ) || ( c == '\r' ) || ( c == '\t' ) )
+    c = ' ';
+  else if ( ( (unsigned char)c < 32 ) || ( c == 127 ) )
+    return;
+
+  if ( *len == *capacidad )
+  {
+    *capacidad *= 2;
+    *texto = (char *)realloc ( *texto, *capacidad );
+  }
+  (*texto) [ *len ] = c;
+  (*len)++;
+}
 
-  // Inicializaciones.
-  linea_inicializar ( &lineaActual );
-  linea_inicializar ( &lineaHistorial );
-  historial_cargar_desde_fichero ( hist, FICHERO_HISTORIAL );
-  historial_guardar_a_fichero ( hist, FICHERO_HISTORIAL );
-  registrar_comandos_internos ();
+static void procesar_pegado ( Linea* linea )
+{
+  // Leemos todo el texto pegado hasta la marca de final y lo insertamos
+  // de una sola vez en la linea.
+  const char* marcaFinal = obtener_secuencia_escape ( PEGADO_FIN );
+  int lenMarca = strlen ( marcaFinal );
+  int coincidencia = 0;
+  int capacidad = 256;
+  int len = 0;
+  char* texto = (char *)malloc ( capacidad );
+  char c;
+  int i;
 
-  // Seales.
-  signal ( SIGTERM, sighandler );
-  signal ( SIGINT, sighandler );
+  while ( ( coincidencia < lenMarca ) && ( getch ( &c ) == 1 ) )
+  {
+    if ( c == marcaFinal [ coincidencia ] )
+    {
+      coincidencia++;
+    }
+    else
+    {
+      // Lo que parecía la marca de final formaba parte del texto.
+      for ( i = 0; i < coincidencia; ++i )
+        anyadir_caracter_pegado ( &texto, &len, &capacidad, marcaFinal [ i ] );
+
+      if ( c == marcaFinal [ 0 ] )
+      {
+        coincidencia = 1;
+      }
+      else
+      {
+        coincidencia = 0;
+        anyadir_caracter_pegado ( &texto, &len, &capacidad, c );
+      }
+    }
+  }
 
-  // Mostramos el prompt.
-  mostrar_prompt ();
+  linea_insertar ( linea, texto, len );
+  free ( texto );
+}
 
-  // Bucle principal.
-  char c;
-  int n = 0;
-  while ( continuar && ( ( n = getch ( &c ) ) == 1 ) )
+static void procesar_tecla ( char c )
+{
+  switch ( c )
   {
-    switch ( c )
-    {
-      case 4:
-        // CTRL+D
-        if ( linea->len == 0 )
-        {
-          continuar = 0;
-          writef ( 1, "exit\n" );
-        }
-        break;
+    case 4:
+      // CTRL+D
+      if ( ( linea->len == 0 ) && ( lineaDocumentos != NULL ) )
+      {
+        // Termina los here-documents a medio leer y ejecuta la linea.
+        hacer_eco ( '\r' );
+        hacer_eco ( '\n' );
+        ejecutar_linea_interactiva ( lineaDocumentos );
+      }
+      else if ( linea->len == 0 )
+      {
+        continuar = 0;
+        salida_escribir ( "exit\n", 5 );
+      }
+      break;
 
-      case 11:
-        // CTRL+K
-        ejecutar_secuencia_escape ( LINEA_LIMPIAR_DERECHA );
-        linea_eliminar_desde_cursor ( linea );
-        break;
-      case 12:
-        // CTRL+L (Limpiar pantalla)
-        hacer_eco ( 12 );
-        linea_mostrar_reset ( linea );
-        break;
-      case '\t':
-        procesar_sugerencias ( linea );
-        break;
-      case 8:
-        // CTRL+H
-      case 127:
-        // Backspace
-        linea_backspace ( linea );
-        break;
-      case 27:
-        // Secuencia de escape
-        linea_anyadir_secuencia_escape ( linea, c, hacer_eco );
-        break;
-      default:
-        // Almacenamos el caracter leido
-        if ( c != '\n' )
+    case 11:
+      // CTRL+K
+      linea_eliminar_desde_cursor ( linea );
+      break;
+    case 12:
+      // CTRL+L (Limpiar pantalla)
+      ejecutar_secuencia_escape ( PANTALLA_LIMPIAR );
+      linea_mostrar_reset ( linea );
+      break;
+    case '\t':
+      latencia_clasificar ( LATENCIA_SUGERENCIAS );
+      procesar_sugerencias ( linea );
+      break;
+    case 8:
+      // CTRL+H
+    case 127:
+      // Backspace
+      latencia_clasificar ( LATENCIA_BORRADO );
+      linea_backspace ( linea );
+      break;
+    case 27:
+      // Secuencia de escape
+      latencia_clasificar ( LATENCIA_ESCAPE );
+      linea_anyadir_secuencia_escape ( linea, c );
+      break;
+    default:
+      // Almacenamos el caracter leido
+      if ( c != '\n' )
+      {
+        latencia_clasificar ( ( linea->escape.len > 0 ) ? LATENCIA_ESCAPE : LATENCIA_INSERCION );
+        linea_anyadir ( linea, c );
+
+        // Verificamos si se ha completado alguna secuencia de escape y procesamos
+        // algunos casos concretos. Las secuencias desconocidas se descartan.
+        CodigoSecuencia codigoEscape = procesar_secuencia_escape ( linea, NULL );
+        switch ( codigoEscape )
         {
-          linea_anyadir ( linea, c, hacer_eco );
-
-          // Verificamos si tenemos que mostrar secuencias de escape y procesamos
-          // algunos casos concretos.
-          CodigoSecuencia codigoEscape = procesar_secuencia_escape ( linea, NULL );
-          switch ( codigoEscape )
+          case SECUENCIA_MAXIMA:
+          case SECUENCIA_NO_INICIADA:
+          case SECUENCIA_NO_FINALIZADA:
+            break;
+          case SECUENCIA_INEXISTENTE:
+            linea_limpiar_secuencia_escape ( linea );
+            break;
+
+          default:
+            linea_procesar_secuencia_escape ( linea, codigoEscape );
+            linea_limpiar_secuencia_escape ( linea );
+            break;
+
+          // Casos concretos.
+          // Texto pegado.
+          case PEGADO_INICIO:
+            linea_limpiar_secuencia_escape ( linea );
+            latencia_clasificar ( LATENCIA_INSERCION );
+            procesar_pegado ( linea );
+            break;
+
+          // Historial.
+          case FLECHA_ARRIBA:
           {
-            case SECUENCIA_MAXIMA:
-            case SECUENCIA_NO_INICIADA:
-            case SECUENCIA_NO_FINALIZADA:
-              break;
-            case SECUENCIA_INEXISTENTE:
-              linea_mostrar_secuencia_escape ( linea, hacer_eco );
-              linea_limpiar_secuencia_escape ( linea );
-              break;
-
-            default:
-              if ( linea_procesar_secuencia_escape ( linea, codigoEscape ) == 1 )
-              {
-                ejecutar_secuencia_escape ( codigoEscape );
-              }
-              linea_limpiar_secuencia_escape ( linea );
-              break;
+            char* lineaContenido;
 
-            // Casos concretos.
-            // Historial.
-            case FLECHA_ARRIBA:
+            linea_limpiar_secuencia_escape ( linea );
+            latencia_clasificar ( LATENCIA_HISTORIAL );
+
+            ++posicion_historial;
+            lineaContenido = historial_obtener ( hist, posicion_historial );
+            if ( lineaContenido == NULL )
+            {
+              --posicion_historial;
+            }
+            else
             {
-              char* lineaContenido;
+              if ( linea == &lineaActual )
+                linea = &lineaHistorial;
+              linea_cargar_contenido ( linea, lineaContenido );
+            }
 
-              linea_limpiar_secuencia_escape ( linea );
+            break;
+          }
 
-              ++posicion_historial;
-              lineaContenido = historial_obtener ( hist, posicion_historial );
-              if ( lineaContenido == NULL )
-              {
-                --posicion_historial;
-              }
-              else
-              {
-                if ( linea == &lineaActual )
-                  linea = &lineaHistorial;
-                linea_cargar_contenido ( linea, lineaContenido );
-                linea_mostrar_reset ( linea );
-              }
+          case FLECHA_ABAJO:
+          {
+            char* lineaContenido;
 
-              break;
-            }
+            linea_limpiar_secuencia_escape ( linea );
+            latencia_clasificar ( LATENCIA_HISTORIAL );
 
-            case FLECHA_ABAJO:
+            if ( posicion_historial > -1 )
             {
-              char* lineaContenido;
-
-              linea_limpiar_secuencia_escape ( linea );
-
+              --posicion_historial;
+            
               if ( posicion_historial > -1 )
               {
-                --posicion_historial;
-              
-                if ( posicion_historial > -1 )
-                {
-                  lineaContenido = historial_obtener ( hist, posicion_historial );
-                  if ( lineaContenido != NULL )
-                  {
-                    linea = &lineaHistorial;
-                    linea_cargar_contenido ( linea, lineaContenido );
-                    linea_mostrar_reset ( linea );
-                  }
-                }
-                else
+                lineaContenido = historial_obtener ( hist, posicion_historial );
+                if ( lineaContenido != NULL )
                 {
-                  linea = &lineaActual;
-                  linea->cursor = linea->len;
-                  linea_mostrar_reset ( linea );
+                  linea = &lineaHistorial;
+                  linea_cargar_contenido ( linea, lineaContenido );
                 }
               }
-
-              break;
+              else
+              {
+                linea = &lineaActual;
+                linea->cursor = linea->len;
+              }
             }
 
-            case PAGINA_ARRIBA:
-            {
-              char* lineaContenido;
+            break;
+          }
 
-              linea_limpiar_secuencia_escape ( linea );
+          case PAGINA_ARRIBA:
+          {
+            char* lineaContenido;
 
-              posicion_historial += 5;
-              if ( posicion_historial >= historial_tamanyo ( hist ) )
-                posicion_historial = historial_tamanyo ( hist ) - 1;
+            linea_limpiar_secuencia_escape ( linea );
+            latencia_clasificar ( LATENCIA_HISTORIAL );
 
-              lineaContenido = historial_obtener ( hist, posicion_historial );
-              if ( lineaContenido != NULL )
-              {
-                if ( linea == &lineaActual )
-                  linea = &lineaHistorial;
-                linea_cargar_contenido ( linea, lineaContenido );
-                linea_mostrar_reset ( linea );
-              }
+            posicion_historial += 5;
+            if ( posicion_historial >= historial_tamanyo ( hist ) )
+              posicion_historial = historial_tamanyo ( hist ) - 1;
 
-              break;
+            lineaContenido = historial_obtener ( hist, posicion_historial );
+            if ( lineaContenido != NULL )
+            {
+              if ( linea == &lineaActual )
+                linea = &lineaHistorial;
+              linea_cargar_contenido ( linea, lineaContenido );
             }
 
-            case PAGINA_ABAJO:
+            break;
+          }
+
+          case PAGINA_ABAJO:
+          {
+            char* lineaContenido;
+
+            linea_limpiar_secuencia_escape ( linea );
+            latencia_clasificar ( LATENCIA_HISTORIAL );
+            if ( posicion_historial > -1 )
             {
-              char* lineaContenido;
+              posicion_historial -= 5;
+              if ( posicion_historial < 0 )
+                posicion_historial = -1;
 
-              linea_limpiar_secuencia_escape ( linea );
               if ( posicion_historial > -1 )
               {
-                posicion_historial -= 5;
-                if ( posicion_historial < 0 )
-                  posicion_historial = -1;
-
-                if ( posicion_historial > -1 )
-                {
-                  lineaContenido = historial_obtener ( hist, posicion_historial );
-                  if ( lineaContenido != NULL )
-                  {
-                    linea = &lineaHistorial;
-                    linea_cargar_contenido ( linea, lineaContenido );
-                    linea_mostrar_reset ( linea );
-                  }
-                }
-                else
+                lineaContenido = historial_obtener ( hist, posicion_historial );
+                if ( lineaContenido != NULL )
                 {
-                  linea = &lineaActual;
-                  linea_mostrar_reset ( linea );
+                  linea = &lineaHistorial;
+                  linea_cargar_contenido ( linea, lineaContenido );
                 }
               }
+              else
+              {
+                linea = &lineaActual;
+              }
             }
           }
         }
+      }
+
+      // Si leemos un salto de linea, el comando ha sido introducido completamente.
+      else
+      {
+        // Descartamos las secuencias de escape iniciadas pero no finalizadas.
+        linea_limpiar_secuencia_escape ( linea );
+
+        // Introducimos el salto de linea en pantalla.
+        hacer_eco ( '\r' );
+        hacer_eco ( '\n' );
 
-        // Si leemos un salto de linea, el comando ha sido introducido completamente.
+        // Si la linea abre here-documents, sus cuerpos llegan en las lineas
+        // siguientes, que pedimos con el prompt secundario.
+        if ( leer_documentos ( linea_hacer_string ( linea ) ) )
+        {
+          linea = &lineaActual;
+          posicion_historial = -1;
+          linea_vaciar ( linea );
+          pantalla_mostrar_prompt ();
+        }
         else
         {
-          // Nos aseguramos de que no queden secuencias de escape iniciadas pero no finalizadas.
-          linea_mostrar_secuencia_escape ( linea, hacer_eco );
-          linea_limpiar_secuencia_escape ( linea );
+          ejecutar_linea_interactiva ( linea_hacer_string ( linea ) );
+        }
+      }
+  }
+}
 
-          // Introducimos el salto de linea en pantalla.
-          hacer_eco ( '\r' );
-          hacer_eco ( '\n' );
+static int ejecutar_interactivo ()
+{
+  // Señales. Se reciben a través del bucle de eventos, junto con la entrada.
+  if ( eventos_inicializar () == -1 )
+    error ( "eventos_inicializar" );
 
-          // Procesamos el comando introducido.
-          if ( procesar_comando ( linea_hacer_string( linea ), envp, vars, aliases ) == COMANDO_SALIR )
-            continuar = 0;
+  // Control de trabajos: grupos de procesos y cesión del terminal.
+  trabajos_inicializar ( 1 );
 
-          // Reiniciamos el acceso al historial.
-          linea = &lineaActual;
-          posicion_historial = -1;
-          linea_inicializar ( linea );
+  // Mostramos el prompt, dejando el terminal en modo crudo mientras se edita la linea.
+  SesionTerminal* sesion = sesion_obtener_instancia ();
+  sesion_entrar_modo_crudo ( sesion );
+  pantalla_mostrar_prompt ();
+  salida_volcar ();
 
-          if ( continuar )
-            mostrar_prompt ();
-        }
+  // Bucle principal.
+  char c;
+  int n = 0;
+  Evento evento;
+  while ( continuar )
+  {
+    // Mientras quede entrada leída por procesar no esperamos a nuevos eventos.
+    if ( sesion_pendientes ( sesion ) > 0 )
+    {
+      getch ( &c );
+      procesar_tecla ( c );
+    }
+    else if ( eventos_esperar ( &evento ) == -1 )
+    {
+      n = -1;
+      break;
+    }
+    else if ( evento.tipo == EVENTO_SENYAL )
+    {
+      procesar_senyal ( evento.senyal );
+    }
+    else
+    {
+      n = sesion_rellenar ( sesion );
+      if ( n <= 0 )
+        break;
+      latencia_marcar_entrada ();
+    }
+
+    // Mostramos los cambios de la linea y enviamos al terminal todo lo generado
+    // por este evento de una sola vez, anotando cuánto ha tardado desde que
+    // llegó la entrada.
+    if ( continuar )
+      pantalla_actualizar ( linea );
+    salida_volcar ();
+    latencia_registrar ();
+  }
+
+  sesion_salir_modo_crudo ( sesion );
+  eventos_finalizar ();
+
+  return n;
+}
+
+// Fuente de las lineas a ejecutar sin terminal: un fichero o el comando de -c.
+typedef char* (*SiguienteLinea) ( void* fuente );
+
+static char* siguiente_linea_lector ( void* fuente )
+{
+  return lector_leer_linea ( (LectorLineas *)fuente );
+}
+
+static char* siguiente_linea_comando ( void* fuente )
+{
+  char** texto = (char **)fuente;
+  char* linea = *texto;
+  char* salto;
+
+  if ( linea == NULL )
+    return NULL;
+
+  salto = strchr ( linea, '\n' );
+  if ( salto != NULL )
+    *salto = '\0';
+  *texto = salto ? ( salto + 1 ) : NULL;
+
+  return linea;
+}
+
+static void ejecutar_linea_lotes ( char* texto, SiguienteLinea siguiente, void* fuente )
+{
+  Documentos docs;
+  char* copia = NULL;
+  char* cuerpo;
+
+  // Saltamos los blancos iniciales y los comentarios, incluida la linea #!
+  // con la que comienzan los scripts.
+  while ( ( *texto == ' ' ) || ( *texto == '\t' ) )
+    ++texto;
+  if ( *texto == '#' )
+    return;
+
+  // Los cuerpos de los here-documents son las lineas siguientes, hasta sus
+  // delimitadores. La linea leída deja de ser válida al leer otra.
+  documentos_inicializar ( &docs, texto );
+  if ( documentos_pendientes ( &docs ) > 0 )
+  {
+    copia = strdup ( texto );
+    texto = copia;
+    while ( ( documentos_pendientes ( &docs ) > 0 ) && ( ( cuerpo = siguiente ( fuente ) ) != NULL ) )
+      documentos_anyadir_linea ( &docs, cuerpo );
+  }
+
+  if ( procesar_comando ( texto, entorno, vars, aliases, &docs ) == COMANDO_SALIR )
+    continuar = 0;
+
+  documentos_liberar ( &docs );
+  free ( copia );
+
+  // Sin bucle de eventos, recogemos aquí los trabajos en segundo plano.
+  trabajos_notificar ( 1 );
+}
+
+static int ejecutar_lotes ( int fd )
+{
+  // Sin prompt, eco ni modo crudo: cada linea leída va directamente a procesar_comando.
+  LectorLineas* lector = lector_crear ( fd );
+  char* texto;
+
+  while ( continuar && ( ( texto = lector_leer_linea ( lector ) ) != NULL ) )
+    ejecutar_linea_lotes ( texto, siguiente_linea_lector, lector );
+
+  lector_liberar ( lector );
+  return 0;
+}
+
+static int ejecutar_comando_argumento ( const char* comando )
+{
+  // Ejecutamos una a una las lineas del comando recibido con -c.
+  char* copia = strdup ( comando );
+  char* resto = copia;
+  char* texto;
+
+  while ( continuar && ( ( texto = siguiente_linea_comando ( &resto ) ) != NULL ) )
+    ejecutar_linea_lotes ( texto, siguiente_linea_comando, &resto );
+
+  free ( copia );
+  return 0;
+}
+
+int main ( int argc, const char* argv[], char* envp[] )
+{
+  const char* comando = NULL;
+  const char* script = NULL;
+  int interactivo;
+  int codigo;
+  int n;
+
+  // Argumentos: bashinga [-c comando | script]
+  if ( ( argc > 1 ) && ( strcmp ( argv[1], "-c" ) == 0 ) )
+  {
+    if ( argc < 3 )
+    {
+      writef ( 2, "uso: %s [-c comando | script]\n", argv[0] );
+      return 2;
+    }
+    comando = argv[2];
+  }
+  else if ( argc > 1 )
+  {
+    script = argv[1];
+  }
+  interactivo = ( comando == NULL ) && ( script == NULL ) && isatty ( 0 );
+
+  linea = &lineaActual;
+  entorno = envp;
+
+  // Definido en historial.h
+  hist = historial_obtener_instancia ();
+
+  // Definido en variables.h
+  vars = variables_crear ();
+
+  // Definido en aliases.h
+  aliases = aliases_obtener_instancia ();
+
+  // Inicializaciones. Sólo las sesiones interactivas usan el fichero de historial.
+  linea_inicializar ( &lineaActual );
+  linea_inicializar ( &lineaHistorial );
+  if ( interactivo )
+  {
+    historial_cargar_desde_fichero ( hist, FICHERO_HISTORIAL );
+    historial_guardar_a_fichero ( hist, FICHERO_HISTORIAL );
+  }
+  registrar_comandos_internos ();
+
+  if ( interactivo )
+  {
+    n = ejecutar_interactivo ();
+  }
+  else if ( comando != NULL )
+  {
+    n = ejecutar_comando_argumento ( comando );
+  }
+  else if ( script != NULL )
+  {
+    int fd = open ( script, O_RDONLY | O_CLOEXEC );
+    if ( fd == -1 )
+    {
+      perror ( script );
+      return 127;
     }
+    n = ejecutar_lotes ( fd );
+    close ( fd );
+  }
+  else
+  {
+    n = ejecutar_lotes ( 0 );
   }
 
+  // El shell termina con el código del último comando.
+  codigo = variables_obtener ( vars, "?" ) ? atoi ( variables_obtener ( vars, "?" ) ) : 0;
+
   // Finalizaciones
+  trabajos_finalizar ();
+  linea_liberar ( &lineaActual );
+  linea_liberar ( &lineaHistorial );
   historial_eliminar ( hist );
   variables_eliminar ( vars );
   aliases_eliminar ( aliases );
@@ -310,5 +661,5 @@ int main ( int argc, const char* argv[], char* envp[] )
   if ( n == -1 )
     error ( "getch" );
 
-  return 0;
+  return codigo;
 }
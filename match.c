@@ -1,174 +0,0 @@
-/*
- * IRC - Internet Relay Chat, common/match.c
- * Copyright (C) 1990 Jarkko Oikarinen
- *
- * This program is free software; you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation; either version 1, or (at your option)
- * any later version.
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with this program; if not, write to the Free Software
- * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
- */
-
-/*
- * Compare if a given string (name) matches the given
- * mask (which can contain wild cards: '*' - match any
- * number of chars, '?' - match any single character.
- *
- * return  0, if match
- *         1, if no match
- */
-
-/*
- * Modificado por Alberto Alonso, para hacerlo "case-sensitive".
- */
-
-/*
- * match
- *
- * Rewritten by Andrea Cocito (Nemesi), November 1998.
- *
- */
-
-/****************** Nemesi's match() ***************/
-
-int match(const char *mask, const char *string)
-{
-  const char *m = mask, *s = string;
-  char ch;
-  const char *bm, *bs;          /* Will be reg anyway on a decent CPU/compiler */
-
-  /* Process the "head" of the mask, if any */
-  while ((ch = *m++) && (ch != '*'))
-    switch (ch)
-    {
-      case '\\':
-        if (*m == '?' || *m == '*')
-          ch = *m++;
-      default:
-        if (*s != ch)
-          return 1;
-      case '?':
-        if (!*s++)
-          return 1;
-    };
-  if (!ch)
-    return *s;
-
-  /* We got a star: quickly find if/where we match the next char */
-got_star:
-  bm = m;                       /* Next try rollback here */
-  while ((ch = *m++))
-    switch (ch)
-    {
-      case '?':
-        if (!*s++)
-          return 1;
-      case '*':
-        bm = m;
-        continue;               /* while */
-      case '\\':
-        if (*m == '?' || *m == '*')
-          ch = *m++;
-      default:
-        goto break_while;       /* C is structured ? */
-    };
-break_while:
-  if (!ch)
-    return 0;                   /* mask ends with '*', we got it */
-  while (*s++ != ch)
-    if (!*s)
-      return 1;
-  bs = s;                       /* Next try start from here */
-
-  /* Check the rest of the "chunk" */
-  while ((ch = *m++))
-  {
-    switch (ch)
-    {
-      case '*':
-        goto got_star;
-      case '\\':
-        if (*m == '?' || *m == '*')
-          ch = *m++;
-      default:
-        if (*s != ch)
-        {
-          m = bm;
-          s = bs;
-          goto got_star;
-        };
-      case '?':
-        if (!*s++)
-          return 1;
-    };
-  };
-  if (*s)
-  {
-    m = bm;
-    s = bs;
-    goto got_star;
-  };
-  return 0;
-}
-
-/*
- * collapse()
- * Collapse a pattern string into minimal components.
- * This particular version is "in place", so that it changes the pattern
- * which is to be reduced to a "minimal" size.
- *
- * (C) Carlo Wood - 6 Oct 1998
- * Speedup rewrite by Andrea Cocito, December 1998.
- * Note that this new optimized alghoritm can *only* work in place.
- */
-
-char *collapse(char *mask)
-{
-  int star = 0;
-  char *m = mask;
-  char *b;
-
-  if (m)
-  {
-    do
-    {
-      if ((*m == '*') && ((m[1] == '*') || (m[1] == '?')))
-      {
-        b = m;
-        do
-        {
-          if (*m == '*')
-            star = 1;
-          else
-          {
-            if (star && (*m != '?'))
-            {
-              *b++ = '*';
-              star = 0;
-            };
-            *b++ = *m;
-            if ((*m == '\\') && ((m[1] == '*') || (m[1] == '?')))
-              *b++ = *++m;
-          };
-        }
-        while (*m++);
-        break;
-      }
-      else
-      {
-        if ((*m == '\\') && ((m[1] == '*') || (m[1] == '?')))
-          m++;
-      };
-    }
-    while (*m++);
-  };
-  return mask;
-}
@@ -1,4 +0,0 @@
-#pragma once
-
-int match(const char *mask, const char *string);
-char *collapse(char *mask);
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       pantalla.c
+ * DESCRIPCIÓN:   Mostrado diferencial de la linea en edición.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "io.h"
+#include "pantalla.h"
+#include "prompt.h"
+#include "resaltado.h"
+#include "sesion.h"
+#include "terminal.h"
+
+// Lo último que se ha mostrado en pantalla tras el prompt.
+static struct
+{
+  int valido;                 // ¿Coincide el estado con lo que hay en pantalla?
+  char* texto;                // Contenido mostrado.
+  unsigned char* estilos;     // Estilo con el que se ha mostrado cada caracter.
+  unsigned char* nuevosEstilos; // Estilos de la linea a mostrar.
+  int len;                    // Tamanyo del contenido mostrado.
+  int capacidad;              // Tamanyo reservado para el contenido.
+  int cursor;                 // Columna en la que está el cursor, relativa al final del prompt.
+} pantalla = { 0, NULL, NULL, NULL, 0, 0, 0 };
+
+static void reservar_texto ( int len )
+{
+  if ( len >= pantalla.capacidad )
+  {
+    pantalla.capacidad = ( len + 1 ) * 2;
+    pantalla.texto = (char *)realloc ( pantalla.texto, pantalla.capacidad );
+    pantalla.estilos = (unsigned char *)realloc ( pantalla.estilos, pantalla.capacidad );
+    pantalla.nuevosEstilos = (unsigned char *)realloc ( pantalla.nuevosEstilos, pantalla.capacidad );
+  }
+}
+
+static void cambiar_estilo ( unsigned char anterior, unsigned char estilo )
+{
+  if ( anterior != ESTILO_NORMAL )
+    ejecutar_secuencia_escape ( ATRIBUTOS_NORMALES );
+  if ( estilo & ESTILO_NEGRITA )
+    ejecutar_secuencia_escape ( ATRIBUTO_NEGRITA );
+  if ( ESTILO_OBTENER_COLOR ( estilo ) >= 0 )
+    ejecutar_secuencia_escape_parametro ( COLOR_TEXTO, ESTILO_OBTENER_COLOR ( estilo ) );
+}
+
+// Escribe el texto mostrado entre las dos posiciones con sus estilos, y deja
+// el terminal con los atributos normales.
+static void escribir_texto ( int desde, int hasta )
+{
+  unsigned char actual = ESTILO_NORMAL;
+  int i;
+
+  while ( desde < hasta )
+  {
+    for ( i = desde; ( i < hasta ) && ( pantalla.estilos[i] == pantalla.estilos[desde] ); ++i )
+      ;
+    if ( pantalla.estilos[desde] != actual )
+    {
+      cambiar_estilo ( actual, pantalla.estilos[desde] );
+      actual = pantalla.estilos[desde];
+    }
+    salida_escribir ( &(pantalla.texto[desde]), i - desde );
+    desde = i;
+  }
+
+  if ( actual != ESTILO_NORMAL )
+    ejecutar_secuencia_escape ( ATRIBUTOS_NORMALES );
+}
+
+static void mover_cursor ( int desde, int hasta )
+{
+  if ( hasta < desde )
+  {
+    ejecutar_secuencia_escape_repetir ( CURSOR_IZQUIERDA, desde - hasta );
+  }
+  else if ( hasta > desde )
+  {
+    // Volver a escribir lo que ya hay en pantalla avanza el cursor con un
+    // solo byte por columna. En saltos largos sale más corto parametrizarlo.
+    char secuencia [ 32 ];
+    int len = formatear_secuencia_escape ( CURSOR_DERECHA_N, hasta - desde, secuencia, sizeof(secuencia) );
+
+    if ( ( len > 0 ) && ( len < ( hasta - desde ) ) )
+      salida_escribir ( secuencia, len );
+    else
+      escribir_texto ( desde, hasta );
+  }
+}
+
+void pantalla_mostrar_prompt ()
+{
+  mostrar_prompt ();
+  pantalla.valido = 1;
+  pantalla.len = 0;
+  pantalla.cursor = 0;
+}
+
+void pantalla_invalidar ()
+{
+  pantalla.valido = 0;
+}
+
+void pantalla_actualizar ( Linea* linea )
+{
+  int len;
+  int comun;
+  int desde;
+
+  if ( !sesion_eco_activo ( sesion_obtener_instancia () ) )
+    return;
+
+  // Leemos la linea sin mover su hueco, copiando sólo lo que cambia.
+  len = linea->len;
+  reservar_texto ( len );
+
+  if ( !pantalla.valido )
+  {
+    // Redibujamos todo desde el comienzo de la linea.
+    linea_copiar ( linea, 0, len, pantalla.texto );
+    resaltado_estilos ( linea, 0, pantalla.estilos );
+    pantalla.len = len;
+
+    salida_escribir ( "\r", 1 );
+    mostrar_prompt ();
+    escribir_texto ( 0, len );
+    ejecutar_secuencia_escape ( LINEA_LIMPIAR_DERECHA );
+    mover_cursor ( len, linea->cursor );
+
+    pantalla.cursor = linea->cursor;
+    pantalla.valido = 1;
+    return;
+  }
+
+  // Buscamos hasta dónde coincide lo mostrado con la nueva linea.
+  comun = 0;
+  while ( ( comun < len ) && ( comun < pantalla.len ) && ( linea_caracter ( linea, comun ) == pantalla.texto[comun] ) )
+    ++comun;
+
+  // El estilo sólo puede cambiar antes de la primera diferencia en la palabra
+  // que la contiene, así que basta con calcularlo desde ella.
+  desde = resaltado_estilos ( linea, comun, pantalla.nuevosEstilos );
+  while ( ( desde < comun ) && ( pantalla.nuevosEstilos[desde] == pantalla.estilos[desde] ) )
+    ++desde;
+  if ( desde < comun )
+    comun = desde;
+
+  if ( ( comun < len ) || ( comun < pantalla.len ) )
+  {
+    // Reescribimos sólo desde la primera diferencia, limpiando lo que sobre.
+    mover_cursor ( pantalla.cursor, comun );
+    linea_copiar ( linea, comun, len, &(pantalla.texto[comun]) );
+    memcpy ( &(pantalla.estilos[comun]), &(pantalla.nuevosEstilos[comun]), len - comun );
+    escribir_texto ( comun, len );
+    if ( pantalla.len > len )
+      ejecutar_secuencia_escape ( LINEA_LIMPIAR_DERECHA );
+    pantalla.cursor = len;
+    pantalla.len = len;
+  }
+
+  mover_cursor ( pantalla.cursor, linea->cursor );
+  pantalla.cursor = linea->cursor;
+}
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       paralelo.c
+ * DESCRIPCIÓN:   Ejecución en paralelo de un comando sobre una lista de elementos.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#define _GNU_SOURCE             // memfd_create
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "cadena.h"
+#include "io.h"
+#include "lanzador.h"
+#include "lector.h"
+#include "paralelo.h"
+#include "trabajos.h"
+
+#define PARALELO_MAXIMO_FALLIDOS 101
+
+// Cada una de las ejecuciones en curso.
+typedef struct
+{
+  pid_t pid;                    // 0 si la ranura está libre.
+  int salida;                   // Fichero en memoria con la salida agrupada, o -1.
+  char* descripcion;            // Linea ejecutada, para los mensajes.
+} RanuraParalelo;
+
+typedef struct
+{
+  int maxProcesos;
+  int agrupar;
+  int detallar;
+
+  char** plantilla;
+  int numPlantilla;
+  int usaMarcador;              // ¿Aparece {} en la plantilla?
+
+  char** elementos;             // Elementos tras ":::", o NULL para leer de la entrada.
+  int numElementos;
+  int siguienteElemento;
+  LectorLineas* lector;
+
+  int entradaNula;              // /dev/null, para los hijos cuando leemos de la entrada.
+} Paralelo;
+
+static int paralelo_interpretar ( Paralelo* paralelo, int argc, char* argv[] )
+{
+  int i = 1;
+  int j;
+
+  memset ( paralelo, 0, sizeof(Paralelo) );
+  paralelo->maxProcesos = sysconf ( _SC_NPROCESSORS_ONLN );
+  if ( paralelo->maxProcesos < 1 )
+    paralelo->maxProcesos = 1;
+  paralelo->entradaNula = -1;
+
+  // Opciones.
+  while ( ( i < argc ) && ( argv[i][0] == '-' ) )
+  {
+    if ( strcmp ( argv[i], "-j" ) == 0 )
+    {
+      if ( ( ( i + 1 ) >= argc ) || ( atoi ( argv[i + 1] ) < 1 ) )
+        return -1;
+      paralelo->maxProcesos = atoi ( argv[i + 1] );
+      i += 2;
+    }
+    else if ( strcmp ( argv[i], "-g" ) == 0 )
+    {
+      paralelo->agrupar = 1;
+      ++i;
+    }
+    else if ( strcmp ( argv[i], "-v" ) == 0 )
+    {
+      paralelo->detallar = 1;
+      ++i;
+    }
+    else
+    {
+      return -1;
+    }
+  }
+
+  // El comando, ya separado en argumentos al expandir la linea, llega hasta ":::".
+  paralelo->plantilla = &(argv[i]);
+  for ( j = i; ( j < argc ) && ( strcmp ( argv[j], ":::" ) != 0 ); ++j )
+  {
+    if ( strstr ( argv[j], "{}" ) != NULL )
+      paralelo->usaMarcador = 1;
+  }
+  paralelo->numPlantilla = j - i;
+  if ( paralelo->numPlantilla == 0 )
+    return -1;
+
+  if ( j < argc )
+  {
+    paralelo->elementos = &(argv[j + 1]);
+    paralelo->numElementos = argc - j - 1;
+  }
+
+  return 0;
+}
+
+static const char* paralelo_siguiente_elemento ( Paralelo* paralelo )
+{
+  if ( paralelo->elementos != NULL )
+  {
+    if ( paralelo->siguienteElemento == paralelo->numElementos )
+      return NULL;
+    return paralelo->elementos [ paralelo->siguienteElemento++ ];
+  }
+
+  // Sin ":::", una linea de la entrada estándar por elemento.
+  if ( paralelo->lector == NULL )
+    paralelo->lector = lector_crear ( 0 );
+  return lector_leer_linea ( paralelo->lector );
+}
+
+static char* paralelo_sustituir ( const char* palabra, const char* elemento )
+{
+  Cadena resultado;
+  const char* p = palabra;
+  const char* marcador;
+
+  cadena_inicializar ( &resultado );
+  while ( ( marcador = strstr ( p, "{}" ) ) != NULL )
+  {
+    cadena_anyadir_n ( &resultado, p, marcador - p );
+    cadena_anyadir ( &resultado, elemento );
+    p = marcador + 2;
+  }
+  cadena_anyadir ( &resultado, p );
+
+  return resultado.datos;
+}
+
+static pid_t paralelo_lanzar ( Paralelo* paralelo, RanuraParalelo* ranura, const char* elemento )
+{
+  char** argv = (char **)malloc ( sizeof(char *) * ( paralelo->numPlantilla + 2 ) );
+  Redirecciones redirecciones;
+  Cadena descripcion;
+  int argc = 0;
+  int i;
+
+  // Cada elemento es un único argumento, aunque contenga blancos.
+  for ( i = 0; i < paralelo->numPlantilla; ++i )
+    argv [ argc++ ] = paralelo_sustituir ( paralelo->plantilla[i], elemento );
+  if ( !paralelo->usaMarcador )
+    argv [ argc++ ] = strdup ( elemento );
+  argv [ argc ] = NULL;
+
+  cadena_inicializar ( &descripcion );
+  for ( i = 0; i < argc; ++i )
+  {
+    if ( i > 0 )
+      cadena_anyadir_caracter ( &descripcion, ' ' );
+    cadena_anyadir ( &descripcion, argv[i] );
+  }
+
+  memset ( &redirecciones, 0, sizeof(Redirecciones) );
+  redirecciones.entrada = paralelo->entradaNula;
+  redirecciones.salida = -1;
+  redirecciones.cerrar = -1;
+  ranura->salida = -1;
+  if ( paralelo->agrupar )
+  {
+    ranura->salida = memfd_create ( "parallel", MFD_CLOEXEC );
+    redirecciones.salida = ranura->salida;
+  }
+
+  // Los hijos se quedan en el grupo del shell: un CTRL+C los interrumpe a todos.
+  ranura->pid = lanzador_ejecutar ( argv, &redirecciones, -1 );
+  ranura->descripcion = descripcion.datos;
+
+  for ( i = 0; i < argc; ++i )
+    free ( argv[i] );
+  free ( argv );
+
+  return ranura->pid;
+}
+
+static void paralelo_volcar_salida ( int fd )
+{
+  char buffer [ 65536 ];
+  int n;
+
+  lseek ( fd, 0, SEEK_SET );
+  while ( ( n = read ( fd, buffer, sizeof(buffer) ) ) > 0 )
+  {
+    if ( write ( 1, buffer, n ) != n )
+      break;
+  }
+}
+
+static void paralelo_liberar_ranura ( RanuraParalelo* ranura )
+{
+  if ( ranura->salida != -1 )
+    close ( ranura->salida );
+  free ( ranura->descripcion );
+  memset ( ranura, 0, sizeof(RanuraParalelo) );
+  ranura->salida = -1;
+}
+
+int paralelo_ejecutar ( int argc, char* argv[] )
+{
+  Paralelo paralelo;
+  RanuraParalelo* ranuras;
+  const char* elemento;
+  int activos = 0;
+  int fallidos = 0;
+  int interrumpido = 0;
+  int i;
+
+  if ( paralelo_interpretar ( &paralelo, argc, argv ) == -1 )
+  {
+    writef ( 2, "uso: parallel [-j N] [-g] [-v] comando [argumentos] [::: elementos...]\n" );
+    return -1;
+  }
+
+  // Si los elementos vienen de la entrada, los hijos no deben leerla.
+  if ( paralelo.elementos == NULL )
+    paralelo.entradaNula = open ( "/dev/null", O_RDONLY | O_CLOEXEC );
+
+  ranuras = (RanuraParalelo *)calloc ( paralelo.maxProcesos, sizeof(RanuraParalelo) );
+
+  while ( 1 )
+  {
+    struct rusage uso;
+    int estado;
+    pid_t pid;
+
+    // Llenamos las ranuras libres con nuevos elementos.
+    for ( i = 0; !interrumpido && ( i < paralelo.maxProcesos ); ++i )
+    {
+      if ( ranuras[i].pid != 0 )
+        continue;
+      if ( ( elemento = paralelo_siguiente_elemento ( &paralelo ) ) == NULL )
+        break;
+
+      if ( paralelo_lanzar ( &paralelo, &(ranuras[i]), elemento ) == -1 )
+      {
+        ++fallidos;
+        paralelo_liberar_ranura ( &(ranuras[i]) );
+        --i;
+      }
+      else
+      {
+        ++activos;
+      }
+    }
+
+    if ( activos == 0 )
+      break;
+
+    // Esperamos a que termine cualquiera de los hijos para ocupar su ranura.
+    pid = wait4 ( -1, &estado, WUNTRACED, &uso );
+    if ( pid == -1 )
+    {
+      if ( errno == EINTR )
+        continue;
+      break;
+    }
+
+    for ( i = 0; i < paralelo.maxProcesos; ++i )
+    {
+      if ( ranuras[i].pid == pid )
+        break;
+    }
+    if ( i == paralelo.maxProcesos )
+    {
+      // Es de otro trabajo: lo anotamos en el suyo.
+      trabajos_registrar ( pid, estado, &uso );
+      continue;
+    }
+
+    // Las ejecuciones no se pueden detener: si reciben un CTRL+Z, siguen.
+    if ( WIFSTOPPED ( estado ) )
+    {
+      kill ( pid, SIGCONT );
+      continue;
+    }
+
+    if ( ranuras[i].salida != -1 )
+      paralelo_volcar_salida ( ranuras[i].salida );
+
+    if ( trabajos_codigo_salida ( estado ) != 0 )
+    {
+      ++fallidos;
+      writef ( 2, "parallel: %s: código %d\n", ranuras[i].descripcion, trabajos_codigo_salida ( estado ) );
+    }
+    else if ( paralelo.detallar )
+    {
+      writef ( 2, "parallel: %s: código 0\n", ranuras[i].descripcion );
+    }
+
+    // Tras un CTRL+C no lanzamos nada más.
+    if ( WIFSIGNALED ( estado ) && ( WTERMSIG ( estado ) == SIGINT ) )
+      interrumpido = 1;
+
+    paralelo_liberar_ranura ( &(ranuras[i]) );
+    --activos;
+  }
+
+  free ( ranuras );
+  if ( paralelo.lector != NULL )
+    lector_liberar ( paralelo.lector );
+  if ( paralelo.entradaNula != -1 )
+    close ( paralelo.entradaNula );
+
+  return ( fallidos > PARALELO_MAXIMO_FALLIDOS ) ? PARALELO_MAXIMO_FALLIDOS : fallidos;
+}
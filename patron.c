@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       patron.c
+ * DESCRIPCIÓN:   Patrones con comodines (*, ?, [...]) compilados.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#define _GNU_SOURCE             // memmem
+
+#include <string.h>
+#include "patron.h"
+
+typedef enum
+{
+  PATRON_CARACTER,
+  PATRON_CUALQUIERA,
+  PATRON_CLASE,
+  PATRON_ASTERISCO
+} TipoElemento;
+
+// Un patrón compilado es una lista de elementos, cada uno de los cuales
+// encaja con un caracter, salvo los asteriscos. De ellos se sacan los
+// literales que tiene que contener cualquier nombre que encaje, de forma que
+// la mayoría de los nombres se descartan sin llegar a recorrer el patrón.
+struct Patron_
+{
+  unsigned char* tipos;
+  char* caracteres;                   // Caracter de cada elemento PATRON_CARACTER.
+  const unsigned char** clases;       // Mapa de bits de cada elemento PATRON_CLASE.
+  int numElementos;
+
+  int minimo;                         // Caracteres que consume como mínimo.
+  int hayAsterisco;
+  int lenPrefijo;                     // Caracteres fijos al comienzo.
+  int lenSufijo;                      // Caracteres fijos al final, tras el último *.
+  int inicioLiteral;                  // Literal más largo entre el prefijo y el sufijo.
+  int lenLiteral;
+  int exacto;                         // ¿Basta con los literales para decidir?
+};
+
+// Devuelve el ] que cierra la clase que se abre en texto, o NULL si no se cierra.
+static const char* fin_de_clase ( const char* texto )
+{
+  const char* p = texto + 1;
+
+  if ( ( *p == '!' ) || ( *p == '^' ) )
+    ++p;
+  // Un ] justo al comienzo forma parte de la clase.
+  if ( *p == ']' )
+    ++p;
+
+  for ( ; ( *p != '\0' ) && ( *p != ']' ); ++p )
+  {
+    if ( ( *p == '\\' ) && ( p[1] != '\0' ) )
+      ++p;
+  }
+
+  return ( *p == ']' ) ? p : NULL;
+}
+
+char* patron_buscar_comodin ( const char* texto )
+{
+  const char* p;
+
+  for ( p = texto; *p != '\0'; ++p )
+  {
+    if ( ( *p == '*' ) || ( *p == '?' ) || ( ( *p == '[' ) && ( fin_de_clase ( p ) != NULL ) ) )
+      return (char *)p;
+    if ( ( *p == '\\' ) && ( p[1] != '\0' ) )
+      ++p;
+  }
+
+  return NULL;
+}
+
+static void anyadir_a_clase ( unsigned char* clase, unsigned char desde, unsigned char hasta )
+{
+  int c;
+
+  for ( c = desde; c <= hasta; ++c )
+    clase [ c >> 3 ] |= ( 1 << ( c & 7 ) );
+}
+
+static const unsigned char* compilar_clase ( Arena* arena, const char* texto, const char* fin )
+{
+  unsigned char* clase = (unsigned char *)arena_reservar ( arena, 32 );
+  const char* p = texto + 1;
+  int negada = 0;
+  int i;
+
+  memset ( clase, 0, 32 );
+  if ( ( *p == '!' ) || ( *p == '^' ) )
+  {
+    negada = 1;
+    ++p;
+  }
+
+  // El primer caracter puede ser un ], que no cierra la clase.
+  do
+  {
+    unsigned char desde;
+    unsigned char hasta;
+
+    if ( ( *p == '\\' ) && ( p + 1 < fin ) )
+      ++p;
+    desde = hasta = (unsigned char)*p++;
+
+    if ( ( *p == '-' ) && ( p + 1 < fin ) )
+    {
+      ++p;
+      if ( ( *p == '\\' ) && ( p + 1 < fin ) )
+        ++p;
+      hasta = (unsigned char)*p++;
+    }
+
+    if ( desde <= hasta )
+      anyadir_a_clase ( clase, desde, hasta );
+  } while ( p < fin );
+
+  if ( negada )
+  {
+    for ( i = 0; i < 32; ++i )
+      clase[i] = ~clase[i];
+  }
+  // El fin de cadena nunca forma parte de un nombre.
+  clase[0] &= ~1;
+
+  return clase;
+}
+
+// Calcula los literales que usa patron_coincide para descartar nombres.
+static void preparar_filtro ( Patron* patron )
+{
+  int fin;
+  int tramos = 0;
+  int i;
+  int j;
+
+  patron->minimo = 0;
+  patron->hayAsterisco = 0;
+  for ( i = 0; i < patron->numElementos; ++i )
+  {
+    if ( patron->tipos[i] == PATRON_ASTERISCO )
+      patron->hayAsterisco = 1;
+    else
+      patron->minimo++;
+  }
+
+  for ( i = 0; ( i < patron->numElementos ) && ( patron->tipos[i] == PATRON_CARACTER ); ++i )
+    ;
+  patron->lenPrefijo = i;
+
+  // Sin asteriscos, la longitud es fija y el resto se compara tal cual.
+  patron->lenSufijo = 0;
+  if ( patron->hayAsterisco )
+  {
+    for ( i = patron->numElementos; ( i > 0 ) && ( patron->tipos[i - 1] == PATRON_CARACTER ); --i )
+      ;
+    patron->lenSufijo = patron->numElementos - i;
+  }
+
+  // Buscamos el tramo de caracteres fijos más largo de lo que queda en medio.
+  // Si en medio sólo hay asteriscos y como mucho un tramo, los literales
+  // deciden por sí solos.
+  fin = patron->numElementos - patron->lenSufijo;
+  patron->inicioLiteral = patron->lenPrefijo;
+  patron->lenLiteral = 0;
+  patron->exacto = 1;
+  for ( i = patron->lenPrefijo; i < fin; i = j )
+  {
+    if ( patron->tipos[i] != PATRON_CARACTER )
+    {
+      if ( patron->tipos[i] != PATRON_ASTERISCO )
+        patron->exacto = 0;
+      j = i + 1;
+      continue;
+    }
+
+    for ( j = i; ( j < fin ) && ( patron->tipos[j] == PATRON_CARACTER ); ++j )
+      ;
+    if ( ++tramos > 1 )
+      patron->exacto = 0;
+    if ( ( j - i ) > patron->lenLiteral )
+    {
+      patron->inicioLiteral = i;
+      patron->lenLiteral = j - i;
+    }
+  }
+}
+
+Patron* patron_compilar ( Arena* arena, const char* texto )
+{
+  Patron* patron = (Patron *)arena_reservar ( arena, sizeof(Patron) );
+  int maximo = strlen ( texto );
+  const char* p = texto;
+
+  // Cada elemento sale de al menos un caracter del texto.
+  memset ( patron, 0, sizeof(Patron) );
+  patron->tipos = (unsigned char *)arena_reservar ( arena, maximo + 1 );
+  patron->caracteres = (char *)arena_reservar ( arena, maximo + 1 );
+  patron->clases = (const unsigned char **)arena_reservar ( arena, sizeof(unsigned char *) * ( maximo + 1 ) );
+
+  while ( *p != '\0' )
+  {
+    int n = patron->numElementos;
+    const char* fin;
+
+    patron->caracteres[n] = '\0';
+    patron->clases[n] = NULL;
+
+    if ( *p == '*' )
+    {
+      // Varios asteriscos seguidos equivalen a uno.
+      if ( ( n == 0 ) || ( patron->tipos[n - 1] != PATRON_ASTERISCO ) )
+      {
+        patron->tipos[n] = PATRON_ASTERISCO;
+        patron->numElementos++;
+      }
+      ++p;
+      continue;
+    }
+
+    if ( *p == '?' )
+    {
+      patron->tipos[n] = PATRON_CUALQUIERA;
+      ++p;
+    }
+    else if ( ( *p == '[' ) && ( ( fin = fin_de_clase ( p ) ) != NULL ) )
+    {
+      patron->tipos[n] = PATRON_CLASE;
+      patron->clases[n] = compilar_clase ( arena, p, fin );
+      p = fin + 1;
+    }
+    else
+    {
+      if ( ( *p == '\\' ) && ( p[1] != '\0' ) )
+        ++p;
+      patron->tipos[n] = PATRON_CARACTER;
+      patron->caracteres[n] = *p++;
+    }
+    patron->numElementos++;
+  }
+
+  preparar_filtro ( patron );
+  return patron;
+}
+
+static int coincide_elemento ( const Patron* patron, int i, unsigned char c )
+{
+  switch ( patron->tipos[i] )
+  {
+    case PATRON_CARACTER:
+      return ( (unsigned char)patron->caracteres[i] == c );
+    case PATRON_CLASE:
+      return ( patron->clases[i][ c >> 3 ] & ( 1 << ( c & 7 ) ) ) != 0;
+    default:
+      return 1;
+  }
+}
+
+int patron_coincide ( const Patron* patron, const char* nombre )
+{
+  int len = strlen ( nombre );
+  int fin = patron->numElementos - patron->lenSufijo;
+  int finNombre = len - patron->lenSufijo;
+  int estrella = -1;
+  int sEstrella = 0;
+  int p;
+  int s;
+
+  // Primero lo barato: longitud, comienzo, final y el literal de en medio.
+  if ( ( len < patron->minimo ) || ( !patron->hayAsterisco && ( len != patron->minimo ) ) )
+    return 0;
+  if ( memcmp ( nombre, patron->caracteres, patron->lenPrefijo ) != 0 )
+    return 0;
+  if ( memcmp ( &(nombre[finNombre]), &(patron->caracteres[fin]), patron->lenSufijo ) != 0 )
+    return 0;
+  if ( ( patron->lenLiteral > 0 ) &&
+       ( memmem ( &(nombre[patron->lenPrefijo]), finNombre - patron->lenPrefijo,
+                  &(patron->caracteres[patron->inicioLiteral]), patron->lenLiteral ) == NULL ) )
+    return 0;
+  if ( patron->exacto )
+    return 1;
+
+  // Comparamos lo que queda entre el prefijo y el sufijo. Al fallar se vuelve
+  // al último asterisco, que pasa a cubrir un caracter más.
+  p = patron->lenPrefijo;
+  s = patron->lenPrefijo;
+  while ( s < finNombre )
+  {
+    if ( ( p < fin ) && ( patron->tipos[p] == PATRON_ASTERISCO ) )
+    {
+      estrella = ++p;
+      sEstrella = s;
+    }
+    else if ( ( p < fin ) && coincide_elemento ( patron, p, (unsigned char)nombre[s] ) )
+    {
+      ++p;
+      ++s;
+    }
+    else if ( estrella >= 0 )
+    {
+      p = estrella;
+      s = ++sEstrella;
+    }
+    else
+      return 0;
+  }
+
+  while ( ( p < fin ) && ( patron->tipos[p] == PATRON_ASTERISCO ) )
+    ++p;
+  return ( p == fin );
+}
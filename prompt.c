@@ -27,11 +27,11 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       prompt.c
- * DESCRIPCIN:   Generacin y mostrado del prompt.
+ * DESCRIPCIÓN:   Generación y mostrado del prompt.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #include <stdlib.h>
@@ -45,6 +45,7 @@ static char prompt_procesado_base [ 256 ] = { 0 };
 static char prompt_ultimo_usuario [ 256 ];
 static char prompt_ultimo_host [ 256 ];
 static char prompt_ultimo_dir [ 256 ];
+static int prompt_es_secundario = 0;
 
 static void procesar_prompt ( const char* prompt )
 {
@@ -142,7 +143,7 @@ static void procesar_prompt ( const char* prompt )
           // Comprobamos si debemos utilizar el host reducido.
           if ( prompt[i] == 'h' )
           {
-            // Si el nombre de host es compuesto, nos quedamos slo con el primer nombre.
+            // Si el nombre de host es compuesto, nos quedamos sólo con el primer nombre.
             ptr = strchr ( &(prompt_procesado[p]), '.' );
             if ( ptr != NULL )
             {
@@ -235,9 +236,20 @@ static inline int hay_que_actualizar_prompt ()
   return 0;
 }
 
+void prompt_secundario ( int activo )
+{
+  prompt_es_secundario = activo;
+}
+
 void mostrar_prompt ()
 {
   const char* PS1 = getenv ( "PROMPT" );
+
+  if ( prompt_es_secundario )
+  {
+    salida_escribir ( PROMPT_SECUNDARIO, strlen ( PROMPT_SECUNDARIO ) );
+    return;
+  }
   if ( PS1 == NULL )
     PS1 = PROMPT_POR_DEFECTO;
 
@@ -247,5 +259,5 @@ void mostrar_prompt ()
     procesar_prompt ( PS1 );
   }
 
-  writef ( 1, prompt_procesado );
+  salida_escribir ( prompt_procesado, strlen ( prompt_procesado ) );
 }
@@ -27,13 +27,17 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       prompt.h
- * DESCRIPCIN:   Procesamiento y mostrado del prompt.
+ * DESCRIPCIÓN:   Procesamiento y mostrado del prompt.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #pragma once
 
 void mostrar_prompt ();
+
+// Mientras está activo se muestra PROMPT_SECUNDARIO, por ejemplo al leer
+// los cuerpos de los here-documents.
+void prompt_secundario ( int activo );
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       resaltado.c
+ * DESCRIPCIÓN:   Resaltado de sintaxis de la linea en edición.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <string.h>
+#include "aliases.h"
+#include "cadena.h"
+#include "comandos.h"
+#include "lexico.h"
+#include "resaltado.h"
+#include "rutas.h"
+
+#define COLOR_ROJO      1
+#define COLOR_VERDE     2
+#define COLOR_AMARILLO  3
+#define COLOR_CIAN      6
+
+// Lo que se sabe del nombre de programa que comienza en un token, guardado
+// en su marca para no volver a buscarlo mientras no cambie la palabra.
+#define PROGRAMA_DESCONOCIDO  0
+#define PROGRAMA_EXISTE       1
+#define PROGRAMA_NO_EXISTE    2
+#define PROGRAMA_SIN_RESALTAR 3
+
+static int resaltado_activo = 0;
+
+void resaltado_activar ( int activar )
+{
+  resaltado_activo = activar;
+}
+
+int resaltado_activado ()
+{
+  return resaltado_activo;
+}
+
+static int buscar_programa ( const char* nombre )
+{
+  // Lo que aún hay que expandir (asignaciones, variables, comillas...) no
+  // se sabe qué programa será.
+  if ( strpbrk ( nombre, "=$`'\"\\*?[~" ) != NULL )
+    return PROGRAMA_SIN_RESALTAR;
+
+  if ( es_comando_interno ( nombre ) ||
+       ( aliases_obtener ( aliases_obtener_instancia (), nombre ) != NULL ) ||
+       rutas_existe ( rutas_obtener_instancia (), nombre ) )
+    return PROGRAMA_EXISTE;
+
+  return PROGRAMA_NO_EXISTE;
+}
+
+// Estilo de la palabra que comienza en el token indice, en la posición dada.
+static unsigned char estilo_palabra ( Linea* linea, int indice, int posicion )
+{
+  static Cadena nombre;
+  Lexico* lexico = &(linea->lexico);
+  Token* token = lexico_obtener ( lexico, indice );
+
+  if ( !lexico_token_es_comando ( token ) )
+    return ESTILO_NORMAL;
+
+  if ( token->marca == PROGRAMA_DESCONOCIDO )
+  {
+    int fin = posicion + token->len;
+    int i;
+
+    for ( i = indice + 1; ( i < lexico_num_tokens ( lexico ) ) && lexico_token_continua_palabra ( lexico_obtener ( lexico, i ) ); ++i )
+      fin += lexico_obtener ( lexico, i )->len;
+
+    if ( nombre.datos == NULL )
+      cadena_inicializar ( &nombre );
+    cadena_vaciar ( &nombre );
+    cadena_reservar ( &nombre, fin - posicion );
+    linea_copiar ( linea, posicion, fin, nombre.datos );
+    nombre.len = fin - posicion;
+    nombre.datos [ nombre.len ] = '\0';
+
+    token->marca = buscar_programa ( nombre.datos );
+  }
+
+  switch ( token->marca )
+  {
+    case PROGRAMA_EXISTE:
+      return ESTILO_COLOR ( COLOR_VERDE );
+    case PROGRAMA_NO_EXISTE:
+      return ESTILO_COLOR ( COLOR_ROJO );
+    default:
+      return ESTILO_NORMAL;
+  }
+}
+
+int resaltado_estilos ( Linea* linea, int desde, unsigned char* estilos )
+{
+  Lexico* lexico = &(linea->lexico);
+  unsigned char estiloPalabra = ESTILO_NORMAL;
+  int inicio;
+  int fin;
+  int esComando;
+  int posicion;
+  int comienzo;
+  int i;
+
+  if ( !resaltado_activo )
+  {
+    memset ( &(estilos[desde]), ESTILO_NORMAL, linea->len - desde );
+    return desde;
+  }
+
+  if ( lexico_palabra ( lexico, desde, &inicio, &fin, &esComando ) && ( inicio < desde ) )
+    desde = inicio;
+  if ( lexico_token ( lexico, desde, &posicion ) == NULL )
+    return desde;
+  comienzo = posicion;
+
+  // Tras lexico_token, el token que contiene la posición es el siguiente al
+  // hueco, y desde él se recorren en orden sin más búsquedas.
+  for ( i = lexico->antes; i < lexico_num_tokens ( lexico ); ++i )
+  {
+    Token* token = lexico_obtener ( lexico, i );
+    unsigned char estilo;
+
+    if ( ( ( token->tipo == TOKEN_PALABRA ) || ( token->tipo == TOKEN_CADENA ) ) && !lexico_token_continua_palabra ( token ) )
+      estiloPalabra = estilo_palabra ( linea, i, posicion );
+
+    switch ( token->tipo )
+    {
+      case TOKEN_PALABRA:    estilo = estiloPalabra; break;
+      case TOKEN_CADENA:     estilo = ESTILO_COLOR ( COLOR_AMARILLO ); break;
+      case TOKEN_OPERADOR:   estilo = ESTILO_NEGRITA; break;
+      case TOKEN_COMENTARIO: estilo = ESTILO_COLOR ( COLOR_CIAN ); break;
+      default:               estilo = ESTILO_NORMAL; break;
+    }
+
+    memset ( &(estilos[posicion]), estilo, token->len );
+    posicion += token->len;
+  }
+
+  return comienzo;
+}
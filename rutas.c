@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       rutas.c
+ * DESCRIPCIÓN:   Caché de las rutas de los programas encontrados en el PATH.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cadena.h"
+#include "config.h"
+#include "io.h"
+#include "rutas.h"
+
+// Programa en caché. Si no se encontró en el PATH, la ruta es NULL: así no
+// volvemos a recorrer el PATH cada vez que se repite un error al escribir.
+typedef struct _NodoHash
+{
+  char* programa;
+  char* ruta;
+  int aciertos;
+  struct _NodoHash* siguiente;
+} NodoHash;
+
+// Directorio del PATH junto con su fecha de modificación al llenar la caché.
+typedef struct
+{
+  char* ruta;
+  struct timespec modificacion;
+} DirectorioPath;
+
+struct Rutas_
+{
+  NodoHash* nodos [ RUTAS_TABLA_HASH_TAMANYO ];
+
+  char* path;                   // Valor del PATH con el que se llenó la caché.
+  DirectorioPath* directorios;
+  int numDirectorios;
+};
+
+static inline unsigned int rutas_hash ( const char* str )
+{
+  // Misma función de dispersión que la de las variables y los aliases.
+  unsigned int result = 0;
+  const char* p = str;
+
+  while ( *p != '\0' )
+  {
+    unsigned int bitsADesplazar = ( result >> 25 ) & 0x0000007F;
+    result = ( result << 7 ) | bitsADesplazar;
+    result = result ^ ((unsigned int )*p & 0x000000FF) ^ ( result >> 8 ) ^ ( result >> 16 ) ^ ( result >> 24 );
+    ++p;
+  }
+
+  return result;
+}
+
+Rutas* rutas_obtener_instancia ()
+{
+  static Rutas* rutas = NULL;
+  if ( rutas == NULL )
+    rutas = rutas_crear ();
+  return rutas;
+}
+
+Rutas* rutas_crear ()
+{
+  Rutas* rutas = (Rutas *)malloc(sizeof(Rutas));
+  memset ( rutas, 0, sizeof(Rutas) );
+  return rutas;
+}
+
+static void rutas_liberar_directorios ( Rutas* rutas )
+{
+  int i;
+
+  for ( i = 0; i < rutas->numDirectorios; ++i )
+    free ( rutas->directorios[i].ruta );
+  free ( rutas->directorios );
+  free ( rutas->path );
+  rutas->directorios = NULL;
+  rutas->numDirectorios = 0;
+  rutas->path = NULL;
+}
+
+void rutas_vaciar ( Rutas* rutas )
+{
+  int i;
+
+  for ( i = 0; i < RUTAS_TABLA_HASH_TAMANYO; ++i )
+  {
+    NodoHash* actual;
+    NodoHash* siguiente;
+    for ( actual = rutas->nodos[i]; actual != NULL; actual = siguiente )
+    {
+      siguiente = actual->siguiente;
+      free ( actual->programa );
+      free ( actual->ruta );
+      free ( actual );
+    }
+    rutas->nodos[i] = NULL;
+  }
+}
+
+void rutas_eliminar ( Rutas* rutas )
+{
+  rutas_vaciar ( rutas );
+  rutas_liberar_directorios ( rutas );
+  free ( rutas );
+}
+
+static void rutas_leer_path ( Rutas* rutas, const char* path )
+{
+  const char* p = path;
+  int capacidad = 0;
+
+  rutas_liberar_directorios ( rutas );
+  rutas->path = strdup ( path );
+
+  // Guardamos cada directorio con su fecha de modificación. Una entrada
+  // vacía equivale al directorio actual.
+  while ( p != NULL )
+  {
+    const char* fin = strchr ( p, ':' );
+    int len = fin ? ( fin - p ) : strlen ( p );
+    DirectorioPath* directorio;
+    struct stat info;
+
+    if ( rutas->numDirectorios == capacidad )
+    {
+      capacidad = capacidad ? capacidad * 2 : 16;
+      rutas->directorios = (DirectorioPath *)realloc ( rutas->directorios, sizeof(DirectorioPath) * capacidad );
+    }
+
+    directorio = &(rutas->directorios [ rutas->numDirectorios ]);
+    rutas->numDirectorios++;
+    memset ( directorio, 0, sizeof(DirectorioPath) );
+    directorio->ruta = ( len > 0 ) ? strndup ( p, len ) : strdup ( "." );
+    if ( stat ( directorio->ruta, &info ) == 0 )
+      directorio->modificacion = info.st_mtim;
+
+    p = fin ? ( fin + 1 ) : NULL;
+  }
+}
+
+static int rutas_directorios_modificados ( Rutas* rutas )
+{
+  struct stat info;
+  struct timespec modificacion;
+  int i;
+
+  for ( i = 0; i < rutas->numDirectorios; ++i )
+  {
+    memset ( &modificacion, 0, sizeof(modificacion) );
+    if ( stat ( rutas->directorios[i].ruta, &info ) == 0 )
+      modificacion = info.st_mtim;
+
+    if ( ( modificacion.tv_sec != rutas->directorios[i].modificacion.tv_sec ) ||
+         ( modificacion.tv_nsec != rutas->directorios[i].modificacion.tv_nsec ) )
+      return 1;
+  }
+
+  return 0;
+}
+
+static void rutas_comprobar_path ( Rutas* rutas )
+{
+  const char* path = getenv ( "PATH" );
+  if ( path == NULL )
+    path = "";
+
+  // Si el PATH ha cambiado, nada de lo guardado sirve.
+  if ( ( rutas->path == NULL ) || ( strcmp ( rutas->path, path ) != 0 ) )
+  {
+    rutas_vaciar ( rutas );
+    rutas_leer_path ( rutas, path );
+  }
+}
+
+static char* rutas_resolver ( Rutas* rutas, const char* programa )
+{
+  Cadena candidato;
+  struct stat info;
+  char* ruta = NULL;
+  int i;
+
+  // Primer directorio del PATH con un fichero ejecutable de ese nombre.
+  cadena_inicializar ( &candidato );
+  for ( i = 0; ( ruta == NULL ) && ( i < rutas->numDirectorios ); ++i )
+  {
+    cadena_vaciar ( &candidato );
+    cadena_anyadir ( &candidato, rutas->directorios[i].ruta );
+    cadena_anyadir_caracter ( &candidato, '/' );
+    cadena_anyadir ( &candidato, programa );
+
+    if ( ( stat ( candidato.datos, &info ) == 0 ) && S_ISREG ( info.st_mode ) &&
+         ( access ( candidato.datos, X_OK ) == 0 ) )
+      ruta = strdup ( candidato.datos );
+  }
+  cadena_liberar ( &candidato );
+
+  return ruta;
+}
+
+static NodoHash* rutas_buscar_nodo ( Rutas* rutas, const char* programa )
+{
+  unsigned int pos = ( rutas_hash ( programa ) % RUTAS_TABLA_HASH_TAMANYO );
+  NodoHash* actual;
+
+  for ( actual = rutas->nodos [ pos ]; actual != NULL; actual = actual->siguiente )
+  {
+    if ( strcmp ( actual->programa, programa ) == 0 )
+      return actual;
+  }
+
+  return NULL;
+}
+
+const char* rutas_buscar ( Rutas* rutas, const char* programa )
+{
+  NodoHash* nodo;
+
+  if ( strchr ( programa, '/' ) != NULL )
+    return programa;
+
+  rutas_comprobar_path ( rutas );
+
+  // Antes de dar por buena una entrada negativa, o de recorrer el PATH por
+  // un programa nuevo, comprobamos que no haya cambiado ningún directorio.
+  nodo = rutas_buscar_nodo ( rutas, programa );
+  if ( ( ( nodo == NULL ) || ( nodo->ruta == NULL ) ) && rutas_directorios_modificados ( rutas ) )
+  {
+    char* path = strdup ( rutas->path );
+    rutas_vaciar ( rutas );
+    rutas_leer_path ( rutas, path );
+    free ( path );
+    nodo = NULL;
+  }
+
+  if ( nodo == NULL )
+  {
+    unsigned int pos = ( rutas_hash ( programa ) % RUTAS_TABLA_HASH_TAMANYO );
+
+    nodo = (NodoHash *)malloc(sizeof(NodoHash));
+    memset ( nodo, 0, sizeof(NodoHash) );
+    nodo->programa = strdup ( programa );
+    nodo->ruta = rutas_resolver ( rutas, programa );
+    nodo->siguiente = rutas->nodos [ pos ];
+    rutas->nodos [ pos ] = nodo;
+  }
+
+  nodo->aciertos++;
+  return nodo->ruta;
+}
+
+int rutas_existe ( Rutas* rutas, const char* programa )
+{
+  NodoHash* nodo;
+  struct stat info;
+  char* ruta;
+
+  if ( strchr ( programa, '/' ) != NULL )
+    return ( stat ( programa, &info ) == 0 ) && S_ISREG ( info.st_mode ) && ( access ( programa, X_OK ) == 0 );
+
+  rutas_comprobar_path ( rutas );
+  nodo = rutas_buscar_nodo ( rutas, programa );
+  if ( ( nodo != NULL ) && ( nodo->ruta != NULL ) )
+    return 1;
+
+  ruta = rutas_resolver ( rutas, programa );
+  free ( ruta );
+  return ( ruta != NULL );
+}
+
+void rutas_olvidar ( Rutas* rutas, const char* programa )
+{
+  unsigned int pos = ( rutas_hash ( programa ) % RUTAS_TABLA_HASH_TAMANYO );
+  NodoHash* actual;
+  NodoHash* anterior = NULL;
+
+  for ( actual = rutas->nodos [ pos ]; actual != NULL; anterior = actual, actual = actual->siguiente )
+  {
+    if ( strcmp ( actual->programa, programa ) == 0 )
+    {
+      if ( anterior )
+        anterior->siguiente = actual->siguiente;
+      else
+        rutas->nodos [ pos ] = actual->siguiente;
+
+      free ( actual->programa );
+      free ( actual->ruta );
+      free ( actual );
+      return;
+    }
+  }
+}
+
+void rutas_mostrar ( Rutas* rutas, int fd )
+{
+  int hayEntradas = 0;
+  int i;
+
+  for ( i = 0; i < RUTAS_TABLA_HASH_TAMANYO; ++i )
+  {
+    NodoHash* actual;
+    for ( actual = rutas->nodos[i]; actual != NULL; actual = actual->siguiente )
+    {
+      if ( !hayEntradas )
+        writef ( fd, "aciertos\tcomando\n" );
+      hayEntradas = 1;
+
+      if ( actual->ruta )
+        writef ( fd, "%8d\t%s\n", actual->aciertos, actual->ruta );
+      else
+        writef ( fd, "%8d\t%s (no encontrado)\n", actual->aciertos, actual->programa );
+    }
+  }
+
+  if ( !hayEntradas )
+    writef ( fd, "hash: tabla vacía\n" );
+}
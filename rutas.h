@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       rutas.h
+ * DESCRIPCIÓN:   Caché de las rutas de los programas encontrados en el PATH.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#pragma once
+
+struct Rutas_;
+typedef struct Rutas_ Rutas;
+
+Rutas* rutas_obtener_instancia ();
+Rutas* rutas_crear ();
+void rutas_eliminar ( Rutas* rutas );
+
+// Devuelve la ruta del programa a ejecutar, o NULL si no está en el PATH.
+// Los nombres que contienen '/' se devuelven tal cual.
+const char* rutas_buscar ( Rutas* rutas, const char* programa );
+
+// ¿Hay un programa con ese nombre? A diferencia de rutas_buscar, no guarda en
+// la caché los que no existen ni cuenta como uso la consulta.
+int rutas_existe ( Rutas* rutas, const char* programa );
+
+// Olvida la ruta de un programa, por ejemplo porque ya no existe.
+void rutas_olvidar ( Rutas* rutas, const char* programa );
+
+// Vacía la caché.
+void rutas_vaciar ( Rutas* rutas );
+
+// Lista los programas en caché con su ruta y el número de veces que se han usado.
+void rutas_mostrar ( Rutas* rutas, int fd );
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       sesion.c
+ * DESCRIPCIÓN:   Sesión de terminal: modo crudo persistente y buffer de entrada.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "config.h"
+#include "io.h"
+#include "sesion.h"
+#include "terminal.h"
+
+struct SesionTerminal_
+{
+  int esTerminal;                             // ¿Es la entrada estándar un terminal?
+  int enModoCrudo;                            // ¿Hemos cambiado los parámetros del terminal?
+  int eco;                                    // Eco original del terminal.
+  struct termios original;                    // Parámetros del terminal al entrar en modo crudo.
+
+  // Buffer circular de entrada.
+  char entrada [ TAMANYO_BUFFER_ENTRADA ];
+  int inicio;                                 // Posición del siguiente caracter a leer.
+  int num;                                    // Número de caracteres pendientes.
+};
+
+SesionTerminal* sesion_obtener_instancia ()
+{
+  static SesionTerminal* sesion = NULL;
+  if ( sesion == NULL )
+  {
+    sesion = (SesionTerminal *)malloc(sizeof(SesionTerminal));
+    memset ( sesion, 0, sizeof(SesionTerminal) );
+    sesion->esTerminal = isatty ( 0 );
+  }
+  return sesion;
+}
+
+void sesion_entrar_modo_crudo ( SesionTerminal* sesion )
+{
+  struct termios crudo;
+
+  if ( !sesion->esTerminal || sesion->enModoCrudo )
+    return;
+
+  // Leemos los parámetros actuales, ya que un programa lanzado desde
+  // el último prompt podría haberlos cambiado.
+  if ( tcgetattr ( 0, &(sesion->original) ) == -1 )
+  {
+    sesion->esTerminal = 0;
+    return;
+  }
+  sesion->eco = ( sesion->original.c_lflag & ECHO ) != 0;
+
+  // Quitamos eco local y modo canónico, devolviendo la entrada en cuanto
+  // haya un caracter en el buffer.
+  crudo = sesion->original;
+  crudo.c_lflag &= ~(ICANON | ECHO);
+  crudo.c_cc[VMIN] = 1;
+  crudo.c_cc[VTIME] = 0;
+
+  if ( tcsetattr ( 0, TCSANOW, &crudo ) == 0 )
+  {
+    sesion->enModoCrudo = 1;
+
+    // Pedimos al terminal que delimite el texto pegado.
+    ejecutar_secuencia_escape ( PEGADO_ACTIVAR );
+  }
+}
+
+void sesion_salir_modo_crudo ( SesionTerminal* sesion )
+{
+  if ( sesion->enModoCrudo )
+  {
+    ejecutar_secuencia_escape ( PEGADO_DESACTIVAR );
+    salida_volcar ();
+    tcsetattr ( 0, TCSANOW, &(sesion->original) );
+    sesion->enModoCrudo = 0;
+  }
+}
+
+int sesion_eco_activo ( SesionTerminal* sesion )
+{
+  return sesion->eco;
+}
+
+int sesion_pendientes ( SesionTerminal* sesion )
+{
+  return sesion->num;
+}
+
+int sesion_rellenar ( SesionTerminal* sesion )
+{
+  int fin;
+  int libres;
+  int n;
+
+  // Leemos tanto como quepa en el hueco contiguo del buffer circular.
+  fin = ( sesion->inicio + sesion->num ) % TAMANYO_BUFFER_ENTRADA;
+  if ( sesion->num == 0 )
+  {
+    sesion->inicio = 0;
+    fin = 0;
+  }
+  libres = TAMANYO_BUFFER_ENTRADA - sesion->num;
+  if ( fin + libres > TAMANYO_BUFFER_ENTRADA )
+    libres = TAMANYO_BUFFER_ENTRADA - fin;
+
+  if ( libres == 0 )
+    return 0;
+
+  // No dejamos nada pendiente de mostrar mientras esperamos la entrada.
+  salida_volcar ();
+
+  do
+  {
+    n = read ( 0, &(sesion->entrada[fin]), libres );
+  } while ( ( n == -1 ) && ( errno == EINTR ) );
+
+  if ( n > 0 )
+    sesion->num += n;
+
+  return n;
+}
+
+int sesion_leer ( SesionTerminal* sesion, char* c )
+{
+  if ( sesion->num == 0 )
+  {
+    int n = sesion_rellenar ( sesion );
+    if ( n <= 0 )
+      return n;
+  }
+
+  *c = sesion->entrada [ sesion->inicio ];
+  sesion->inicio = ( sesion->inicio + 1 ) % TAMANYO_BUFFER_ENTRADA;
+  sesion->num--;
+
+  return 1;
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       sustitucion.c
+ * DESCRIPCIÓN:   Sustitución de comandos: $(comando) y `comando`.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "analizador.h"
+#include "arena.h"
+#include "eventos.h"
+#include "sustitucion.h"
+#include "trabajos.h"
+#include "tuberias.h"
+
+#define SUSTITUCION_TAMANYO_LECTURA 4096
+
+int sustitucion_longitud ( const char* texto )
+{
+  const char* p;
+  char comillas = '\0';
+  int profundidad = 0;
+
+  if ( texto[0] == '`' )
+  {
+    p = strchr ( &(texto[1]), '`' );
+    return ( p != NULL ) ? ( p - texto + 1 ) : 0;
+  }
+
+  // $( ... ), con paréntesis y sustituciones anidadas.
+  for ( p = texto + 1; *p != '\0'; ++p )
+  {
+    if ( comillas != '\0' )
+    {
+      if ( *p == comillas )
+        comillas = '\0';
+    }
+    else if ( ( *p == '"' ) || ( *p == '\'' ) )
+    {
+      comillas = *p;
+    }
+    else if ( *p == '(' )
+    {
+      ++profundidad;
+    }
+    else if ( *p == ')' )
+    {
+      if ( --profundidad == 0 )
+        return p - texto + 1;
+    }
+  }
+
+  return 0;
+}
+
+// Devuelve la salida del comando, reservada en la arena, o NULL si no se
+// pudo ejecutar.
+static char* sustitucion_capturar ( char* comando, Arena* arena, size_t* len,
+                                    EjecutorSustitucion ejecutar, void* contexto )
+{
+  int tuberia [ 2 ];
+  int estado;
+  pid_t pid;
+  char* salida = NULL;
+  size_t capacidad = 0;
+  int n;
+
+  if ( tuberias_crear ( tuberia, 0 ) == -1 )
+  {
+    perror ( "pipe2" );
+    return NULL;
+  }
+
+  pid = fork ();
+  switch ( pid )
+  {
+    case -1:
+      perror ( "fork" );
+      close ( tuberia[0] );
+      close ( tuberia[1] );
+      return NULL;
+
+    case 0:
+      // El subshell escribe en el pipe y no controla trabajos: sigue en el
+      // grupo del shell, que es quien tiene el terminal.
+      dup2 ( tuberia[1], 1 );
+      trabajos_restaurar_hijo ( -1 );
+      trabajos_inicializar ( 0 );
+      eventos_restaurar_hijo ();
+      exit ( ejecutar ( comando, contexto ) );
+  }
+
+  // Leemos directamente sobre la arena, y el búfer crece al doble cada vez
+  // que se llena: la salida puede ser de cualquier tamaño sin copias
+  // cuadráticas. Mientras sea la última reserva de la arena crece sin moverse.
+  close ( tuberia[1] );
+  *len = 0;
+  do
+  {
+    if ( capacidad - *len < SUSTITUCION_TAMANYO_LECTURA )
+    {
+      size_t nuevaCapacidad = ( capacidad == 0 ) ? SUSTITUCION_TAMANYO_LECTURA : ( capacidad * 2 );
+      salida = (char *)arena_ampliar ( arena, salida, capacidad, nuevaCapacidad );
+      capacidad = nuevaCapacidad;
+    }
+    n = read ( tuberia[0], &(salida[*len]), capacidad - *len - 1 );
+    if ( n > 0 )
+      *len += n;
+  } while ( ( n > 0 ) || ( ( n == -1 ) && ( errno == EINTR ) ) );
+  salida[*len] = '\0';
+  close ( tuberia[0] );
+
+  while ( ( waitpid ( pid, &estado, 0 ) == -1 ) && ( errno == EINTR ) );
+  return salida;
+}
+
+typedef struct
+{
+  EjecutorSustitucion ejecutar;
+  void* contexto;
+  Arena* arena;
+} Subshell;
+
+static void sustituir_parte ( PartePalabra* parte, void* contexto )
+{
+  Subshell* subshell = (Subshell *)contexto;
+  char* salida;
+  size_t len;
+
+  salida = sustitucion_capturar ( parte->texto, subshell->arena, &len, subshell->ejecutar, subshell->contexto );
+  if ( salida == NULL )
+  {
+    salida = "";
+    len = 0;
+  }
+
+  // Se descartan siempre los saltos de linea finales.
+  while ( ( len > 0 ) && ( salida[len - 1] == '\n' ) )
+    salida[--len] = '\0';
+
+  parte->texto = salida;
+  parte->tipo = PARTE_LITERAL;
+  parte->expandida = 1;
+}
+
+void sustitucion_expandir ( Tuberia* tuberia, Arena* arena, EjecutorSustitucion ejecutar, void* contexto )
+{
+  Subshell subshell;
+
+  subshell.ejecutar = ejecutar;
+  subshell.contexto = contexto;
+  subshell.arena = arena;
+  analizador_recorrer_partes ( tuberia, PARTE_SUSTITUCION, sustituir_parte, &subshell );
+}
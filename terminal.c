@@ -27,148 +27,304 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       terminal.c
- * DESCRIPCIN:   Control de secuencias de escape de terminales concretos.
+ * DESCRIPCIÓN:   Control de secuencias de escape de terminales concretos.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include "io.h"
 #include "terminal.h"
+#include "terminfo.h"
 
 // Terminales
 #include "vt100.h"
 
-static CodigoSecuencia buscar_codigo_para_secuencia ( const TerminalSecuenciasEscape* terminal, Linea* linea, int* tamanyoSecuencia )
+// Decodificador de secuencias de escape. Las secuencias del terminal se
+// organizan en un trie indexado por byte, de forma que cada byte leído sólo
+// avanza un estado, y las secuencias a enviar se indexan por código.
+typedef struct
 {
-  CodigoSecuencia secuenciaEncontrada = SECUENCIA_INEXISTENTE;
-  int secuenciaEncontradaIndice;
-  const char* secuencia = linea->escape.bytes;
-  int len = linea->escape.len;
+  int siguiente [ 256 ];      // Estado al que se pasa con cada byte. 0 si no hay transición.
+  CodigoSecuencia codigo;     // Código si aquí termina una secuencia, o SECUENCIA_NO_FINALIZADA.
+} EstadoDecodificador;
 
-  // Verificamos que tengamos algo que procesar.
-  if ( len > 0 )
+static struct
+{
+  int construido;
+  EstadoDecodificador* estados;
+  int numEstados;
+  int capacidad;
+
+  const char* salida [ SECUENCIA_MAXIMA ];
+  int salidaLen [ SECUENCIA_MAXIMA ];
+
+  Terminfo* terminfo;
+} decodificador;
+
+// Capacidades de terminfo que usamos para cada código.
+static const struct
+{
+  CodigoSecuencia codigo;
+  CapacidadTerminfo capacidad;
+} capacidadesTerminfo [] = {
+   { FLECHA_ARRIBA,           TI_KCUU1 }
+  ,{ FLECHA_ABAJO,            TI_KCUD1 }
+  ,{ FLECHA_IZQUIERDA,        TI_KCUB1 }
+  ,{ FLECHA_DERECHA,          TI_KCUF1 }
+  ,{ IR_INICIO,               TI_KHOME }
+  ,{ IR_FINAL,                TI_KEND  }
+  ,{ PAGINA_ARRIBA,           TI_KPP   }
+  ,{ PAGINA_ABAJO,            TI_KNP   }
+  ,{ LINEA_SUPRIMIR,          TI_KDCH1 }
+
+  ,{ CURSOR_IZQUIERDA,        TI_CUB1  }
+  ,{ CURSOR_DERECHA,          TI_CUF1  }
+  ,{ CURSOR_IZQUIERDA_N,      TI_CUB   }
+  ,{ CURSOR_DERECHA_N,        TI_CUF   }
+  ,{ CURSOR_COLUMNA,          TI_HPA   }
+  ,{ PANTALLA_LIMPIAR,        TI_CLEAR }
+  ,{ LINEA_LIMPIAR_DERECHA,   TI_EL    }
+  ,{ LINEA_LIMPIAR_IZQUIERDA, TI_EL1   }
+
+  ,{ ATRIBUTOS_NORMALES,      TI_SGR0  }
+  ,{ ATRIBUTO_NEGRITA,        TI_BOLD  }
+  ,{ COLOR_TEXTO,             TI_SETAF }
+};
+
+static int es_parametrizada ( CodigoSecuencia codigo )
+{
+  return ( codigo == CURSOR_IZQUIERDA_N ) ||
+         ( codigo == CURSOR_DERECHA_N ) ||
+         ( codigo == CURSOR_COLUMNA ) ||
+         ( codigo == COLOR_TEXTO );
+}
+
+static int nuevo_estado ()
+{
+  if ( decodificador.numEstados == decodificador.capacidad )
+  {
+    decodificador.capacidad = ( decodificador.capacidad > 0 ) ? decodificador.capacidad * 2 : 32;
+    decodificador.estados = (EstadoDecodificador *)realloc ( decodificador.estados,
+                                                             sizeof(EstadoDecodificador) * decodificador.capacidad );
+  }
+
+  memset ( &(decodificador.estados [ decodificador.numEstados ]), 0, sizeof(EstadoDecodificador) );
+  decodificador.estados [ decodificador.numEstados ].codigo = SECUENCIA_NO_FINALIZADA;
+  return decodificador.numEstados++;
+}
+
+static void anyadir_tecla ( CodigoSecuencia codigo, const char* secuencia )
+{
+  const unsigned char* p = (const unsigned char *)secuencia;
+  int estado = 0;
+
+  // Sólo se reconocen en la entrada las secuencias que comienzan por ESC.
+  if ( *p != 27 )
+    return;
+
+  for ( ; *p != '\0'; ++p )
   {
-    // Almacenamos la maxima longitud que debemos procesar.
-    int maximaLongitud = len;
-    if ( maximaLongitud > terminal->maxBytes )
+    if ( decodificador.estados [ estado ].siguiente [ *p ] == 0 )
     {
-      maximaLongitud = terminal->maxBytes;
+      int nuevo = nuevo_estado ();
+      decodificador.estados [ estado ].siguiente [ *p ] = nuevo;
     }
+    estado = decodificador.estados [ estado ].siguiente [ *p ];
+  }
 
-    // Iteramos por todas las secuencias existentes y, para cada una de ellas, comprobamos
-    // si coincide con los datos de entrada.
-    int i;
-    int curSeq;
-    for ( curSeq = 0; ( curSeq < terminal->numSecuencias ) &&
-                      ( secuenciaEncontrada == SECUENCIA_INEXISTENTE );
-          curSeq++ )
-    {
-      const char* termSeq = terminal->secuencias [ curSeq ].secuencia;
-      int coincidencia = 1;
-      for ( i = 0; ( i < maximaLongitud ) &&
-                     coincidencia &&
-                   ( termSeq [ i ] != 0 );
-            i++ )
-      {
-        if ( termSeq [ i ] != secuencia [ i ] )
-        {
-          coincidencia = 0;
-        }
-      }
+  // Si dos secuencias coinciden, prevalece la primera.
+  if ( decodificador.estados [ estado ].codigo == SECUENCIA_NO_FINALIZADA )
+    decodificador.estados [ estado ].codigo = codigo;
+}
 
-      if ( coincidencia )
-      {
-        // Verificamos que la coincidencia es hasta el final.
-        if ( termSeq [ i ] != 0 )
-        {
-          secuenciaEncontrada = SECUENCIA_NO_FINALIZADA;
-        }
-        else
-        {
-          secuenciaEncontrada = terminal->secuencias [ curSeq ].codigoSecuencia;
-          secuenciaEncontradaIndice = curSeq;
-        }
-
-        if ( tamanyoSecuencia )
-        {
-          *tamanyoSecuencia = i - 1;
-        }
-      }
+static void anyadir_salida ( CodigoSecuencia codigo, const char* secuencia )
+{
+  // Para enviar un código se usa la primera secuencia definida para él.
+  if ( decodificador.salida [ codigo ] == NULL )
+  {
+    decodificador.salida [ codigo ] = secuencia;
+    decodificador.salidaLen [ codigo ] = strlen ( secuencia );
+  }
+}
+
+static void anyadir_secuencia ( CodigoSecuencia codigo, const char* secuencia )
+{
+  if ( codigo < TECLAS_MAXIMA )
+    anyadir_tecla ( codigo, secuencia );
+
+  // Las teclas también se guardan, ya que pueden usarse para reconocerlas
+  // en otros puntos (por ejemplo, el final del texto pegado).
+  anyadir_salida ( codigo, secuencia );
+}
+
+static void anyadir_terminfo ( Terminfo* terminfo )
+{
+  int i;
+
+  for ( i = 0; i < sizeof(capacidadesTerminfo) / sizeof(capacidadesTerminfo[0]); ++i )
+  {
+    CodigoSecuencia codigo = capacidadesTerminfo[i].codigo;
+    const char* secuencia = terminfo_cadena ( terminfo, capacidadesTerminfo[i].capacidad );
+
+    if ( ( secuencia == NULL ) || ( *secuencia == '\0' ) )
+      continue;
+
+    if ( ( codigo > TECLAS_MAXIMA ) && !es_parametrizada ( codigo ) )
+    {
+      // Guardamos las secuencias sin parámetros ya sin los retardos.
+      char buffer [ 64 ];
+      terminfo_parametrizar ( secuencia, NULL, 0, buffer, sizeof(buffer) );
+      secuencia = strdup ( buffer );
     }
+
+    anyadir_secuencia ( codigo, secuencia );
   }
+}
 
-  return secuenciaEncontrada;
+static void construir_decodificador ( Terminfo* terminfo, const TerminalSecuenciasEscape* terminal )
+{
+  int curSeq;
+
+  decodificador.numEstados = 0;
+  nuevo_estado ();
+
+  // Primero las secuencias del terminal según terminfo, y después las de la
+  // tabla por defecto, que completan las que no estén definidas.
+  if ( terminfo )
+    anyadir_terminfo ( terminfo );
+
+  for ( curSeq = 0; curSeq < terminal->numSecuencias; curSeq++ )
+  {
+    anyadir_secuencia ( terminal->secuencias [ curSeq ].codigoSecuencia,
+                        terminal->secuencias [ curSeq ].secuencia );
+  }
+
+  decodificador.construido = 1;
 }
 
 static const TerminalSecuenciasEscape* obtenerSecuenciasEscape ()
 {
-  // Solo vamos a soportar vt100 por el momento.
+  // La tabla vt100 se usa para todo lo que no encontremos en terminfo.
   return obtenerSecuenciasEscapeVT100 ();
 }
 
+static void inicializar_decodificador ()
+{
+  if ( !decodificador.construido )
+  {
+    decodificador.terminfo = terminfo_cargar ( getenv ( "TERM" ) );
+    construir_decodificador ( decodificador.terminfo, obtenerSecuenciasEscape () );
+  }
+}
+
 CodigoSecuencia procesar_secuencia_escape ( Linea* linea, int* tamanyoSecuencia )
 {
-  const TerminalSecuenciasEscape* terminal = obtenerSecuenciasEscape ();
+  int estado;
 
   // Si no estamos en una secuencia de escape, retornamos 0.
   if ( linea->escape.len == 0 )
     return SECUENCIA_NO_INICIADA;
 
-  // Buscamos una secuencia de escape coincidente.
-  CodigoSecuencia codigo = buscar_codigo_para_secuencia ( terminal, linea, tamanyoSecuencia );
+  inicializar_decodificador ();
+
+  // Avanzamos sólo por los bytes que se han añadido desde la última llamada.
+  estado = linea->escape.estado;
+  while ( linea->escape.procesados < linea->escape.len )
+  {
+    unsigned char c = (unsigned char)linea->escape.bytes [ linea->escape.procesados ];
+
+    estado = decodificador.estados [ estado ].siguiente [ c ];
+    if ( estado == 0 )
+      return SECUENCIA_INEXISTENTE;
+
+    linea->escape.procesados++;
+  }
+  linea->escape.estado = estado;
+
+  if ( tamanyoSecuencia )
+    *tamanyoSecuencia = linea->escape.procesados - 1;
+
+  return decodificador.estados [ estado ].codigo;
+}
+
+const char* obtener_secuencia_escape ( CodigoSecuencia codigo )
+{
+  inicializar_decodificador ();
+
+  if ( ( codigo < 0 ) || ( codigo >= SECUENCIA_MAXIMA ) )
+    return NULL;
+  return decodificador.salida [ codigo ];
+}
+
+int formatear_secuencia_escape ( CodigoSecuencia codigo, int parametro, char* destino, int tamanyo )
+{
+  const char* secuencia = obtener_secuencia_escape ( codigo );
+
+  if ( secuencia == NULL )
+    return -1;
 
-  return codigo;
+  if ( es_parametrizada ( codigo ) )
+    return terminfo_parametrizar ( secuencia, &parametro, 1, destino, tamanyo );
+
+  if ( decodificador.salidaLen [ codigo ] >= tamanyo )
+    return -1;
+  memcpy ( destino, secuencia, decodificador.salidaLen [ codigo ] + 1 );
+  return decodificador.salidaLen [ codigo ];
 }
 
 void ejecutar_secuencia_escape ( CodigoSecuencia codigo )
 {
-  const TerminalSecuenciasEscape* terminal = obtenerSecuenciasEscape ();
-  int curSeq;
-  int encontrada = 0;
+  ejecutar_secuencia_escape_repetir ( codigo, 1 );
+}
 
-  for ( curSeq = 0; ( encontrada == 0 ) &&
-                    ( curSeq < terminal->numSecuencias );
-        curSeq++ )
-  {
-    if ( terminal->secuencias [ curSeq ].codigoSecuencia == codigo )
-    {
-      const char* secuencia = terminal->secuencias [ curSeq ].secuencia;
-      encontrada = 1;
-      writef ( 1, secuencia );
-    }
-  }
+void ejecutar_secuencia_escape_parametro ( CodigoSecuencia codigo, int parametro )
+{
+  char buffer [ 64 ];
+  int len = formatear_secuencia_escape ( codigo, parametro, buffer, sizeof(buffer) );
+
+  if ( len > 0 )
+    salida_escribir ( buffer, len );
 }
 
 void ejecutar_secuencia_escape_repetir ( CodigoSecuencia codigo, int nVeces )
 {
-  const TerminalSecuenciasEscape* terminal = obtenerSecuenciasEscape ();
-  int curSeq;
-  int encontrada = 0;
+  const char* secuencia = obtener_secuencia_escape ( codigo );
+  int i;
+
+  if ( secuencia == NULL )
+    return;
 
-  for ( curSeq = 0; ( encontrada == 0 ) &&
-                    ( curSeq < terminal->numSecuencias );
-        curSeq++ )
+  // Para los desplazamientos del cursor, usamos la versión parametrizada
+  // cuando sale más corta que repetir la secuencia.
+  if ( nVeces > 1 )
   {
-    if ( terminal->secuencias [ curSeq ].codigoSecuencia == codigo )
-    {
-      const char* secuencia = terminal->secuencias [ curSeq ].secuencia;
-      char* repeticion = (char *)malloc( terminal->maxBytes * nVeces );
-      int i;
-      int len = strlen(secuencia);
+    CodigoSecuencia parametrizada = SECUENCIA_MAXIMA;
+    char buffer [ 64 ];
+    int len;
+
+    if ( codigo == CURSOR_IZQUIERDA )
+      parametrizada = CURSOR_IZQUIERDA_N;
+    else if ( codigo == CURSOR_DERECHA )
+      parametrizada = CURSOR_DERECHA_N;
 
-      for ( i = 0; i < nVeces; ++i )
+    if ( parametrizada != SECUENCIA_MAXIMA )
+    {
+      len = formatear_secuencia_escape ( parametrizada, nVeces, buffer, sizeof(buffer) );
+      if ( ( len > 0 ) && ( len < ( nVeces * decodificador.salidaLen [ codigo ] ) ) )
       {
-        memcpy ( &(repeticion[i*len]), secuencia, len );
+        salida_escribir ( buffer, len );
+        return;
       }
-
-      encontrada = 1;
-      write ( 1, repeticion, nVeces*len );
-      free ( repeticion );
     }
   }
-}
 
+  for ( i = 0; i < nVeces; ++i )
+  {
+    salida_escribir ( secuencia, decodificador.salidaLen [ codigo ] );
+  }
+}
@@ -27,11 +27,11 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       terminal.h
- * DESCRIPCIN:   Control de secuencias de escape de terminales.
+ * DESCRIPCIÓN:   Control de secuencias de escape de terminales.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #pragma once
@@ -54,5 +54,11 @@ typedef struct
 } TerminalSecuenciasEscape;
 
 CodigoSecuencia procesar_secuencia_escape ( Linea* linea, int* tamanyoSecuencia );
+const char* obtener_secuencia_escape ( CodigoSecuencia codigo );
 void ejecutar_secuencia_escape ( CodigoSecuencia codigo );
 void ejecutar_secuencia_escape_repetir ( CodigoSecuencia codigo, int nVeces );
+
+// Secuencias con un parámetro, como CURSOR_IZQUIERDA_N. formatear_secuencia_escape
+// devuelve el tamaño de la secuencia generada, o -1 si el terminal no la tiene.
+int formatear_secuencia_escape ( CodigoSecuencia codigo, int parametro, char* destino, int tamanyo );
+void ejecutar_secuencia_escape_parametro ( CodigoSecuencia codigo, int parametro );
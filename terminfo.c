@@ -0,0 +1,501 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       terminfo.c
+ * DESCRIPCIÓN:   Lectura de las entradas compiladas de terminfo.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "terminfo.h"
+
+#define TERMINFO_MAGICO           0432    // Formato clásico, números de 16 bits.
+#define TERMINFO_MAGICO_32BITS    01036   // Formato extendido, números de 32 bits.
+#define TERMINFO_MAX_PILA         16
+
+struct Terminfo_
+{
+  unsigned char* datos;
+  int tamanyo;
+  const unsigned char* offsets;   // Offsets de las cadenas, en little endian.
+  int numCadenas;
+  const char* tablaCadenas;
+  int tamanyoTabla;
+};
+
+static int leer_entero16 ( const unsigned char* p )
+{
+  return (short)( p[0] | ( p[1] << 8 ) );
+}
+
+static unsigned char* leer_fichero ( const char* ruta, int* tamanyo )
+{
+  struct stat info;
+  unsigned char* datos;
+  int fd;
+  int leidos = 0;
+  int n;
+
+  fd = open ( ruta, O_RDONLY );
+  if ( fd == -1 )
+    return NULL;
+
+  if ( ( fstat ( fd, &info ) == -1 ) || ( info.st_size <= 0 ) || ( info.st_size > 65536 ) )
+  {
+    close ( fd );
+    return NULL;
+  }
+
+  datos = (unsigned char *)malloc ( info.st_size );
+  while ( leidos < info.st_size )
+  {
+    n = read ( fd, &(datos[leidos]), info.st_size - leidos );
+    if ( n <= 0 )
+      break;
+    leidos += n;
+  }
+  close ( fd );
+
+  if ( leidos != info.st_size )
+  {
+    free ( datos );
+    return NULL;
+  }
+
+  *tamanyo = leidos;
+  return datos;
+}
+
+static unsigned char* buscar_en_directorio ( const char* directorio, const char* terminal, int* tamanyo )
+{
+  char ruta [ 512 ];
+  unsigned char* datos;
+
+  if ( ( directorio == NULL ) || ( *directorio == '\0' ) )
+    return NULL;
+
+  // Los sistemas usan como subdirectorio la primera letra del nombre, o su
+  // valor en hexadecimal.
+  snprintf ( ruta, sizeof(ruta), "%s/%c/%s", directorio, terminal[0], terminal );
+  datos = leer_fichero ( ruta, tamanyo );
+  if ( datos == NULL )
+  {
+    snprintf ( ruta, sizeof(ruta), "%s/%02x/%s", directorio, (unsigned char)terminal[0], terminal );
+    datos = leer_fichero ( ruta, tamanyo );
+  }
+
+  return datos;
+}
+
+static unsigned char* buscar_entrada ( const char* terminal, int* tamanyo )
+{
+  static const char* directoriosSistema [] = { "/etc/terminfo", "/lib/terminfo", "/usr/share/terminfo", NULL };
+  char directorio [ 512 ];
+  unsigned char* datos;
+  const char* p;
+  int i;
+
+  datos = buscar_en_directorio ( getenv ( "TERMINFO" ), terminal, tamanyo );
+
+  if ( ( datos == NULL ) && ( ( p = getenv ( "HOME" ) ) != NULL ) )
+  {
+    snprintf ( directorio, sizeof(directorio), "%s/.terminfo", p );
+    datos = buscar_en_directorio ( directorio, terminal, tamanyo );
+  }
+
+  // TERMINFO_DIRS es una lista de directorios separados por ':'.
+  p = getenv ( "TERMINFO_DIRS" );
+  while ( ( datos == NULL ) && ( p != NULL ) && ( *p != '\0' ) )
+  {
+    const char* fin = strchr ( p, ':' );
+    int len = fin ? ( fin - p ) : strlen ( p );
+
+    if ( len < sizeof(directorio) )
+    {
+      memcpy ( directorio, p, len );
+      directorio [ len ] = '\0';
+      datos = buscar_en_directorio ( directorio, terminal, tamanyo );
+    }
+    p = fin ? ( fin + 1 ) : NULL;
+  }
+
+  for ( i = 0; ( datos == NULL ) && ( directoriosSistema[i] != NULL ); ++i )
+    datos = buscar_en_directorio ( directoriosSistema[i], terminal, tamanyo );
+
+  return datos;
+}
+
+Terminfo* terminfo_cargar ( const char* terminal )
+{
+  Terminfo* terminfo;
+  unsigned char* datos;
+  int tamanyo;
+  int magico;
+  int tamanyoNombres;
+  int numBooleanos;
+  int numNumeros;
+  int tamanyoNumero;
+  int pos;
+
+  // No aceptamos nombres que puedan salirse del directorio de terminfo.
+  if ( ( terminal == NULL ) || ( *terminal == '\0' ) || ( strchr ( terminal, '/' ) != NULL ) )
+    return NULL;
+
+  datos = buscar_entrada ( terminal, &tamanyo );
+  if ( datos == NULL )
+    return NULL;
+
+  // Cabecera: seis enteros de 16 bits.
+  if ( tamanyo < 12 )
+  {
+    free ( datos );
+    return NULL;
+  }
+
+  magico = leer_entero16 ( &datos[0] );
+  if ( magico == TERMINFO_MAGICO )
+    tamanyoNumero = 2;
+  else if ( magico == TERMINFO_MAGICO_32BITS )
+    tamanyoNumero = 4;
+  else
+  {
+    free ( datos );
+    return NULL;
+  }
+
+  terminfo = (Terminfo *)malloc ( sizeof(Terminfo) );
+  memset ( terminfo, 0, sizeof(Terminfo) );
+  terminfo->datos = datos;
+  terminfo->tamanyo = tamanyo;
+
+  tamanyoNombres = leer_entero16 ( &datos[2] );
+  numBooleanos = leer_entero16 ( &datos[4] );
+  numNumeros = leer_entero16 ( &datos[6] );
+  terminfo->numCadenas = leer_entero16 ( &datos[8] );
+  terminfo->tamanyoTabla = leer_entero16 ( &datos[10] );
+
+  // Saltamos los nombres y los booleanos. Los números comienzan en una posición par.
+  pos = 12 + tamanyoNombres + numBooleanos;
+  if ( pos % 2 )
+    ++pos;
+  pos += numNumeros * tamanyoNumero;
+
+  terminfo->offsets = &(datos[pos]);
+  pos += terminfo->numCadenas * 2;
+  terminfo->tablaCadenas = (const char *)&(datos[pos]);
+
+  if ( ( tamanyoNombres < 0 ) || ( numBooleanos < 0 ) || ( numNumeros < 0 ) ||
+       ( terminfo->numCadenas < 0 ) || ( terminfo->tamanyoTabla < 0 ) ||
+       ( ( pos + terminfo->tamanyoTabla ) > tamanyo ) )
+  {
+    terminfo_liberar ( terminfo );
+    return NULL;
+  }
+
+  return terminfo;
+}
+
+void terminfo_liberar ( Terminfo* terminfo )
+{
+  if ( terminfo )
+  {
+    free ( terminfo->datos );
+    free ( terminfo );
+  }
+}
+
+const char* terminfo_cadena ( Terminfo* terminfo, CapacidadTerminfo capacidad )
+{
+  int offset;
+  const char* cadena;
+
+  if ( ( terminfo == NULL ) || ( capacidad >= terminfo->numCadenas ) )
+    return NULL;
+
+  // Los offsets negativos indican capacidades ausentes o canceladas.
+  offset = leer_entero16 ( &(terminfo->offsets [ capacidad * 2 ]) );
+  if ( ( offset < 0 ) || ( offset >= terminfo->tamanyoTabla ) )
+    return NULL;
+
+  // Nos aseguramos de que la cadena termina dentro de la tabla.
+  cadena = &(terminfo->tablaCadenas [ offset ]);
+  if ( memchr ( cadena, '\0', terminfo->tamanyoTabla - offset ) == NULL )
+    return NULL;
+
+  return cadena;
+}
+
+
+// Intérprete de los parámetros de terminfo. Soporta el lenguaje de pila
+// descrito en terminfo(5), salvo los parámetros de tipo cadena.
+static const char* saltar_condicion ( const char* p, int hastaElse )
+{
+  int nivel = 0;
+
+  // Buscamos el %e o %; que corresponda a este nivel de anidamiento.
+  while ( *p != '\0' )
+  {
+    if ( ( p[0] == '%' ) && ( p[1] != '\0' ) )
+    {
+      if ( p[1] == '?' )
+        ++nivel;
+      else if ( p[1] == ';' )
+      {
+        if ( nivel == 0 )
+          return p + 2;
+        --nivel;
+      }
+      else if ( ( p[1] == 'e' ) && hastaElse && ( nivel == 0 ) )
+        return p + 2;
+      p += 2;
+    }
+    else
+      ++p;
+  }
+
+  return p;
+}
+
+int terminfo_parametrizar ( const char* capacidad, const int* parametros, int numParametros,
+                            char* destino, int tamanyo )
+{
+  int params [ 9 ] = { 0 };
+  int variables [ 52 ] = { 0 };
+  int pila [ TERMINFO_MAX_PILA ];
+  int numPila = 0;
+  int len = 0;
+  const char* p = capacidad;
+  int a;
+  int b;
+  int i;
+
+#define APILAR(x)   do { if ( numPila < TERMINFO_MAX_PILA ) pila [ numPila++ ] = (x); } while ( 0 )
+#define DESAPILAR() ( ( numPila > 0 ) ? pila [ --numPila ] : 0 )
+#define ESCRIBIR(c) do { if ( len < ( tamanyo - 1 ) ) destino [ len++ ] = (c); } while ( 0 )
+
+  if ( tamanyo <= 0 )
+    return 0;
+
+  for ( i = 0; ( i < numParametros ) && ( i < 9 ); ++i )
+    params [ i ] = parametros [ i ];
+
+  while ( *p != '\0' )
+  {
+    // Retardos: $<n> no se envía al terminal.
+    if ( ( p[0] == '$' ) && ( p[1] == '<' ) && ( strchr ( p, '>' ) != NULL ) )
+    {
+      p = strchr ( p, '>' ) + 1;
+      continue;
+    }
+
+    if ( *p != '%' )
+    {
+      ESCRIBIR ( *p );
+      ++p;
+      continue;
+    }
+
+    ++p;
+    switch ( *p )
+    {
+      case '%':
+        ESCRIBIR ( '%' );
+        break;
+
+      case 'c':
+        a = DESAPILAR ();
+        ESCRIBIR ( (char)a );
+        break;
+
+      case 'p':
+        if ( ( p[1] >= '1' ) && ( p[1] <= '9' ) )
+        {
+          ++p;
+          APILAR ( params [ *p - '1' ] );
+        }
+        break;
+
+      case 'P':
+      case 'g':
+      {
+        // Variables dinámicas (a-z) y estáticas (A-Z).
+        char operacion = *p;
+        int indice = -1;
+
+        ++p;
+        if ( ( *p >= 'a' ) && ( *p <= 'z' ) )
+          indice = *p - 'a';
+        else if ( ( *p >= 'A' ) && ( *p <= 'Z' ) )
+          indice = 26 + ( *p - 'A' );
+        else if ( *p == '\0' )
+          --p;
+
+        if ( indice >= 0 )
+        {
+          if ( operacion == 'P' )
+            variables [ indice ] = DESAPILAR ();
+          else
+            APILAR ( variables [ indice ] );
+        }
+        break;
+      }
+
+      case '\'':
+        if ( ( p[1] != '\0' ) && ( p[2] == '\'' ) )
+        {
+          APILAR ( (unsigned char)p[1] );
+          p += 2;
+        }
+        break;
+
+      case '{':
+        a = 0;
+        for ( ++p; ( *p >= '0' ) && ( *p <= '9' ); ++p )
+          a = a * 10 + ( *p - '0' );
+        APILAR ( a );
+        if ( *p != '}' )
+          --p;
+        break;
+
+      case 'l':
+        // No tenemos parámetros de tipo cadena.
+        DESAPILAR ();
+        APILAR ( 0 );
+        break;
+
+      case '+': case '-': case '*': case '/': case 'm':
+      case '&': case '|': case '^': case '=': case '>': case '<':
+      case 'A': case 'O':
+        b = DESAPILAR ();
+        a = DESAPILAR ();
+        switch ( *p )
+        {
+          case '+': APILAR ( a + b ); break;
+          case '-': APILAR ( a - b ); break;
+          case '*': APILAR ( a * b ); break;
+          case '/': APILAR ( b ? ( a / b ) : 0 ); break;
+          case 'm': APILAR ( b ? ( a % b ) : 0 ); break;
+          case '&': APILAR ( a & b ); break;
+          case '|': APILAR ( a | b ); break;
+          case '^': APILAR ( a ^ b ); break;
+          case '=': APILAR ( a == b ); break;
+          case '>': APILAR ( a > b ); break;
+          case '<': APILAR ( a < b ); break;
+          case 'A': APILAR ( a && b ); break;
+          case 'O': APILAR ( a || b ); break;
+        }
+        break;
+
+      case '!':
+        a = DESAPILAR ();
+        APILAR ( !a );
+        break;
+
+      case '~':
+        a = DESAPILAR ();
+        APILAR ( ~a );
+        break;
+
+      case 'i':
+        params [ 0 ]++;
+        params [ 1 ]++;
+        break;
+
+      case '?':
+      case ';':
+        break;
+
+      case 't':
+        // Si la condición es falsa, saltamos a la rama else o al final.
+        if ( !DESAPILAR () )
+        {
+          p = saltar_condicion ( p + 1, 1 );
+          continue;
+        }
+        break;
+
+      case 'e':
+        // Terminada la rama then, saltamos hasta el final de la condición.
+        p = saltar_condicion ( p + 1, 0 );
+        continue;
+
+      case '\0':
+        --p;
+        break;
+
+      default:
+      {
+        // Salida con formato a la printf: %[[:]flags][ancho[.precisión]][doxXs]
+        char formato [ 16 ];
+        char numero [ 32 ];
+        int f = 0;
+        int n;
+
+        formato [ f++ ] = '%';
+        if ( *p == ':' )
+          ++p;
+        while ( ( f < ( sizeof(formato) - 2 ) ) && ( strchr ( "-+# .0123456789", *p ) != NULL ) && ( *p != '\0' ) )
+          formato [ f++ ] = *p++;
+
+        if ( ( *p == 'd' ) || ( *p == 'o' ) || ( *p == 'x' ) || ( *p == 'X' ) )
+        {
+          formato [ f++ ] = *p;
+          formato [ f ] = '\0';
+          n = snprintf ( numero, sizeof(numero), formato, DESAPILAR () );
+          for ( i = 0; ( i < n ) && ( i < sizeof(numero) - 1 ); ++i )
+            ESCRIBIR ( numero[i] );
+        }
+        else if ( *p == 's' )
+        {
+          DESAPILAR ();
+        }
+        else if ( *p == '\0' )
+        {
+          --p;
+        }
+        break;
+      }
+    }
+    ++p;
+  }
+
+#undef APILAR
+#undef DESAPILAR
+#undef ESCRIBIR
+
+  destino [ len ] = '\0';
+  return len;
+}
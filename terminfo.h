@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       terminfo.h
+ * DESCRIPCIÓN:   Lectura de las entradas compiladas de terminfo.
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#pragma once
+
+// Índices de las capacidades de tipo cadena que usamos, según el orden
+// estándar de terminfo (ver term(5)).
+typedef enum
+{
+  TI_CLEAR    = 5,      // clear_screen
+  TI_EL       = 6,      // clr_eol
+  TI_HPA      = 8,      // column_address
+  TI_CUB1     = 14,     // cursor_left
+  TI_CUF1     = 17,     // cursor_right
+  TI_BOLD     = 27,     // enter_bold_mode
+  TI_SGR0     = 39,     // exit_attribute_mode
+  TI_KDCH1    = 59,     // key_dc
+  TI_KCUD1    = 61,     // key_down
+  TI_KHOME    = 76,     // key_home
+  TI_KCUB1    = 79,     // key_left
+  TI_KNP      = 81,     // key_npage
+  TI_KPP      = 82,     // key_ppage
+  TI_KCUF1    = 83,     // key_right
+  TI_KCUU1    = 87,     // key_up
+  TI_CUB      = 111,    // parm_left_cursor
+  TI_CUF      = 112,    // parm_right_cursor
+  TI_KEND     = 164,    // key_end
+  TI_EL1      = 269,    // clr_bol
+  TI_SETAF    = 359     // set_a_foreground
+} CapacidadTerminfo;
+
+struct Terminfo_;
+typedef struct Terminfo_ Terminfo;
+
+// Busca y carga la entrada compilada de un terminal. Devuelve NULL si no
+// se encuentra o no es válida.
+Terminfo* terminfo_cargar ( const char* terminal );
+void terminfo_liberar ( Terminfo* terminfo );
+
+// Devuelve la capacidad tal y como está en la entrada, o NULL si el terminal no la tiene.
+const char* terminfo_cadena ( Terminfo* terminfo, CapacidadTerminfo capacidad );
+
+// Interpreta los parámetros (%p1, %d, %i, ...) de una capacidad y descarta los
+// retardos ($<n>). Devuelve el tamaño del resultado, que se guarda terminado en '\0'.
+int terminfo_parametrizar ( const char* capacidad, const int* parametros, int numParametros,
+                            char* destino, int tamanyo );
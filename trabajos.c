@@ -0,0 +1,717 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       trabajos.c
+ * DESCRIPCIÓN:   Tabla de trabajos y control de trabajos (fg, bg, jobs).
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "io.h"
+#include "trabajos.h"
+
+typedef struct
+{
+  pid_t pid;
+  char* nombre;
+  int estado;                   // Último estado devuelto por wait4.
+  int terminado;
+  int detenido;
+
+  // Medidas para time.
+  struct timespec inicio;
+  struct timespec fin;
+  struct rusage uso;
+} ProcesoTrabajo;
+
+struct Trabajo_
+{
+  int id;
+  pid_t pgid;
+  char* comando;
+
+  ProcesoTrabajo* procesos;
+  int numProcesos;
+  int capacidad;
+
+  int notificar;                // ¿Ha cambiado de estado sin que lo hayamos avisado?
+  int medir;                    // ¿Mostrar los tiempos de cada proceso al terminar?
+  int lanzado;                  // ¿Ha pasado ya a primer o segundo plano?
+  struct termios modos;         // Modos del terminal al detenerse.
+  int tieneModos;
+};
+
+static Trabajo** trabajos = NULL;
+static int numTrabajos = 0;
+static int capacidadTrabajos = 0;
+
+static int control = 0;
+static sigset_t senyalesIgnoradas;
+static struct termios modosShell;
+
+void trabajos_inicializar ( int controlTrabajos )
+{
+  static const int senyales [] = { SIGTSTP, SIGTTIN, SIGTTOU, SIGQUIT };
+  unsigned int i;
+
+  sigemptyset ( &senyalesIgnoradas );
+  control = controlTrabajos && isatty ( 0 );
+  if ( !control )
+    return;
+
+  // Si nos han lanzado en segundo plano, esperamos a que nos pongan en primer plano.
+  while ( tcgetpgrp ( 0 ) != getpgrp () )
+    kill ( -getpgrp (), SIGTTIN );
+
+  // Un CTRL+Z o un CTRL+\ van dirigidos al trabajo en primer plano, nunca al
+  // shell, y éste tiene que poder cambiar el grupo del terminal aunque no esté
+  // en primer plano.
+  for ( i = 0; i < sizeof(senyales) / sizeof(senyales[0]); ++i )
+  {
+    signal ( senyales[i], SIG_IGN );
+    sigaddset ( &senyalesIgnoradas, senyales[i] );
+  }
+
+  // Nos ponemos en nuestro propio grupo y nos quedamos con el terminal.
+  if ( getpgrp () != getpid () )
+    setpgid ( 0, 0 );
+  tcsetpgrp ( 0, getpgrp () );
+  tcgetattr ( 0, &modosShell );
+}
+
+void trabajos_finalizar ()
+{
+  // Los trabajos detenidos no volverían a ejecutarse nunca: los terminamos.
+  while ( numTrabajos > 0 )
+  {
+    Trabajo* trabajo = trabajos [ numTrabajos - 1 ];
+    int i;
+
+    for ( i = 0; control && ( i < trabajo->numProcesos ); ++i )
+    {
+      if ( trabajo->procesos[i].detenido )
+      {
+        kill ( -trabajo->pgid, SIGHUP );
+        kill ( -trabajo->pgid, SIGCONT );
+        break;
+      }
+    }
+
+    trabajos_eliminar ( trabajo );
+  }
+
+  free ( trabajos );
+  trabajos = NULL;
+  capacidadTrabajos = 0;
+}
+
+Trabajo* trabajos_crear ( const char* comando )
+{
+  Trabajo* trabajo = (Trabajo *)malloc(sizeof(Trabajo));
+  int id = 0;
+  int i;
+
+  memset ( trabajo, 0, sizeof(Trabajo) );
+
+  // Como en bash, el nuevo trabajo toma el número siguiente al mayor en uso.
+  for ( i = 0; i < numTrabajos; ++i )
+  {
+    if ( trabajos[i]->id > id )
+      id = trabajos[i]->id;
+  }
+  trabajo->id = id + 1;
+  trabajo->comando = strdup ( comando );
+  for ( i = strlen ( trabajo->comando ); ( i > 0 ) && ( trabajo->comando[i - 1] == ' ' ); --i )
+    trabajo->comando[i - 1] = '\0';
+
+  if ( numTrabajos == capacidadTrabajos )
+  {
+    capacidadTrabajos = capacidadTrabajos ? capacidadTrabajos * 2 : 16;
+    trabajos = (Trabajo **)realloc ( trabajos, sizeof(Trabajo *) * capacidadTrabajos );
+  }
+  trabajos [ numTrabajos ] = trabajo;
+  numTrabajos++;
+
+  return trabajo;
+}
+
+void trabajos_eliminar ( Trabajo* trabajo )
+{
+  int i;
+
+  for ( i = 0; i < numTrabajos; ++i )
+  {
+    if ( trabajos[i] == trabajo )
+    {
+      memmove ( &(trabajos[i]), &(trabajos[i + 1]), sizeof(Trabajo *) * ( numTrabajos - i - 1 ) );
+      numTrabajos--;
+      break;
+    }
+  }
+
+  for ( i = 0; i < trabajo->numProcesos; ++i )
+    free ( trabajo->procesos[i].nombre );
+  free ( trabajo->procesos );
+  free ( trabajo->comando );
+  free ( trabajo );
+}
+
+pid_t trabajos_grupo ( Trabajo* trabajo )
+{
+  return control ? trabajo->pgid : -1;
+}
+
+void trabajos_anyadir_proceso ( Trabajo* trabajo, pid_t pid, const char* nombre )
+{
+  ProcesoTrabajo* proceso;
+
+  if ( trabajo->numProcesos == trabajo->capacidad )
+  {
+    trabajo->capacidad = trabajo->capacidad ? trabajo->capacidad * 2 : 4;
+    trabajo->procesos = (ProcesoTrabajo *)realloc ( trabajo->procesos, sizeof(ProcesoTrabajo) * trabajo->capacidad );
+  }
+
+  proceso = &(trabajo->procesos [ trabajo->numProcesos ]);
+  trabajo->numProcesos++;
+  memset ( proceso, 0, sizeof(ProcesoTrabajo) );
+  proceso->pid = pid;
+  proceso->nombre = strdup ( nombre );
+  clock_gettime ( CLOCK_MONOTONIC, &(proceso->inicio) );
+
+  // El hijo ya se ha puesto en su grupo, pero lo repetimos desde el padre para
+  // que esté hecho antes de lanzar el siguiente proceso o ceder el terminal.
+  if ( control )
+  {
+    if ( trabajo->pgid == 0 )
+      trabajo->pgid = pid;
+    setpgid ( pid, trabajo->pgid );
+  }
+}
+
+static void trabajos_actualizar ( Trabajo* trabajo, ProcesoTrabajo* proceso, int estado, const struct rusage* uso )
+{
+  proceso->estado = estado;
+  if ( WIFSTOPPED ( estado ) )
+  {
+    proceso->detenido = 1;
+  }
+  else if ( WIFCONTINUED ( estado ) )
+  {
+    proceso->detenido = 0;
+  }
+  else
+  {
+    proceso->terminado = 1;
+    proceso->uso = *uso;
+    clock_gettime ( CLOCK_MONOTONIC, &(proceso->fin) );
+  }
+
+  trabajo->notificar = 1;
+}
+
+void trabajos_registrar ( pid_t pid, int estado, const struct rusage* uso )
+{
+  int i;
+  int j;
+
+  // Anotamos el cambio de estado en el trabajo al que pertenezca el proceso,
+  // sea o no el que estamos esperando.
+  for ( i = 0; i < numTrabajos; ++i )
+  {
+    for ( j = 0; j < trabajos[i]->numProcesos; ++j )
+    {
+      if ( trabajos[i]->procesos[j].pid == pid )
+      {
+        trabajos_actualizar ( trabajos[i], &(trabajos[i]->procesos[j]), estado, uso );
+        return;
+      }
+    }
+  }
+}
+
+static void trabajos_dar_por_terminado ( Trabajo* trabajo )
+{
+  int i;
+
+  // Ya no hay hijos que esperar: alguien los recogió antes que nosotros.
+  for ( i = 0; i < trabajo->numProcesos; ++i )
+  {
+    if ( !trabajo->procesos[i].terminado )
+    {
+      trabajo->procesos[i].terminado = 1;
+      clock_gettime ( CLOCK_MONOTONIC, &(trabajo->procesos[i].fin) );
+    }
+  }
+}
+
+static int trabajo_terminado ( Trabajo* trabajo )
+{
+  int i;
+
+  for ( i = 0; i < trabajo->numProcesos; ++i )
+  {
+    if ( !trabajo->procesos[i].terminado )
+      return 0;
+  }
+  return 1;
+}
+
+static int trabajo_detenido ( Trabajo* trabajo )
+{
+  int detenido = 0;
+  int i;
+
+  for ( i = 0; i < trabajo->numProcesos; ++i )
+  {
+    if ( trabajo->procesos[i].detenido && !trabajo->procesos[i].terminado )
+      detenido = 1;
+    else if ( !trabajo->procesos[i].terminado )
+      return 0;
+  }
+  return detenido;
+}
+
+static void trabajos_continuar ( Trabajo* trabajo )
+{
+  int i;
+
+  for ( i = 0; i < trabajo->numProcesos; ++i )
+  {
+    if ( !trabajo->procesos[i].terminado )
+    {
+      trabajo->procesos[i].detenido = 0;
+      if ( !control )
+        kill ( trabajo->procesos[i].pid, SIGCONT );
+    }
+  }
+
+  if ( control )
+    kill ( -trabajo->pgid, SIGCONT );
+}
+
+int trabajos_codigo_salida ( int estado )
+{
+  if ( WIFEXITED ( estado ) )
+    return WEXITSTATUS ( estado );
+  if ( WIFSIGNALED ( estado ) )
+    return 128 + WTERMSIG ( estado );
+  if ( WIFSTOPPED ( estado ) )
+    return 128 + WSTOPSIG ( estado );
+  return 0;
+}
+
+static void trabajos_mostrar_trabajo ( Trabajo* trabajo, int fd, int posicion );
+static void trabajos_mostrar_tiempos ( Trabajo* trabajo, int fd );
+
+static void trabajos_mover_al_final ( Trabajo* trabajo )
+{
+  int i;
+
+  for ( i = 0; i < numTrabajos - 1; ++i )
+  {
+    if ( trabajos[i] == trabajo )
+    {
+      memmove ( &(trabajos[i]), &(trabajos[i + 1]), sizeof(Trabajo *) * ( numTrabajos - i - 1 ) );
+      trabajos [ numTrabajos - 1 ] = trabajo;
+      break;
+    }
+  }
+}
+
+int trabajos_primer_plano ( Trabajo* trabajo, int continuar )
+{
+  ProcesoTrabajo* ultimo;
+  int codigo;
+
+  if ( trabajo->numProcesos == 0 )
+  {
+    trabajos_eliminar ( trabajo );
+    return 0;
+  }
+  trabajo->lanzado = 1;
+
+  if ( control )
+  {
+    if ( continuar && trabajo->tieneModos )
+      tcsetattr ( 0, TCSADRAIN, &(trabajo->modos) );
+    tcsetpgrp ( 0, trabajo->pgid );
+  }
+
+  if ( continuar )
+  {
+    trabajos_continuar ( trabajo );
+  }
+  else if ( control )
+  {
+    // Un proceso que haya intentado usar el terminal antes de cedérselo se
+    // habrá detenido con SIGTTIN o SIGTTOU: lo reanudamos.
+    trabajos_recoger ();
+    if ( trabajo_detenido ( trabajo ) )
+      trabajos_continuar ( trabajo );
+  }
+
+  // Esperamos a que todos los procesos terminen o se detengan. Los hijos de
+  // otros trabajos que terminen mientras tanto quedan anotados en el suyo.
+  while ( !trabajo_terminado ( trabajo ) && !trabajo_detenido ( trabajo ) )
+  {
+    struct rusage uso;
+    int estado;
+    pid_t pid = wait4 ( -1, &estado, WUNTRACED, &uso );
+
+    if ( pid > 0 )
+      trabajos_registrar ( pid, estado, &uso );
+    else if ( errno == ECHILD )
+      trabajos_dar_por_terminado ( trabajo );
+  }
+
+  // Recuperamos el terminal con los modos que tenía el shell.
+  if ( control )
+  {
+    if ( trabajo_detenido ( trabajo ) )
+    {
+      tcgetattr ( 0, &(trabajo->modos) );
+      trabajo->tieneModos = 1;
+    }
+    tcsetpgrp ( 0, getpgrp () );
+    tcsetattr ( 0, TCSADRAIN, &modosShell );
+  }
+
+  ultimo = &(trabajo->procesos [ trabajo->numProcesos - 1 ]);
+  codigo = trabajos_codigo_salida ( ultimo->estado );
+
+  if ( trabajo_detenido ( trabajo ) )
+  {
+    // El trabajo detenido pasa a ser el trabajo actual.
+    trabajos_mover_al_final ( trabajo );
+    writef ( 1, "\n" );
+    trabajos_mostrar_trabajo ( trabajo, 1, numTrabajos - 1 );
+    trabajo->notificar = 0;
+  }
+  else
+  {
+    // Tras un CTRL+C dejamos el prompt en una linea nueva.
+    if ( control && WIFSIGNALED ( ultimo->estado ) && ( WTERMSIG ( ultimo->estado ) == SIGINT ) )
+      writef ( 1, "\n" );
+    if ( trabajo->medir )
+      trabajos_mostrar_tiempos ( trabajo, 2 );
+    trabajos_eliminar ( trabajo );
+  }
+
+  return codigo;
+}
+
+void trabajos_segundo_plano ( Trabajo* trabajo, int continuar )
+{
+  if ( trabajo->numProcesos == 0 )
+  {
+    trabajos_eliminar ( trabajo );
+    return;
+  }
+  trabajo->lanzado = 1;
+
+  if ( continuar )
+  {
+    trabajos_continuar ( trabajo );
+    writef ( 1, "[%d]+ %s &\n", trabajo->id, trabajo->comando );
+  }
+  else if ( control )
+  {
+    writef ( 1, "[%d] %d\n", trabajo->id, (int)trabajos_obtener_pid ( trabajo ) );
+  }
+}
+
+void trabajos_recoger ()
+{
+  struct rusage uso;
+  int estado;
+  pid_t pid;
+
+  while ( ( pid = wait4 ( -1, &estado, WNOHANG | WUNTRACED | WCONTINUED, &uso ) ) > 0 )
+    trabajos_registrar ( pid, estado, &uso );
+}
+
+void trabajos_medir ( Trabajo* trabajo )
+{
+  trabajo->medir = 1;
+}
+
+static double segundos_timespec ( const struct timespec* desde, const struct timespec* hasta )
+{
+  return ( hasta->tv_sec - desde->tv_sec ) + ( hasta->tv_nsec - desde->tv_nsec ) / 1e9;
+}
+
+static double segundos_timeval ( const struct timeval* tiempo )
+{
+  return tiempo->tv_sec + tiempo->tv_usec / 1e6;
+}
+
+static void trabajos_mostrar_tiempos ( Trabajo* trabajo, int fd )
+{
+  struct timespec inicio;
+  struct timespec fin;
+  double user = 0;
+  double sys = 0;
+  long maxrss = 0;
+  long voluntarios = 0;
+  long involuntarios = 0;
+  int i;
+
+  if ( trabajo->numProcesos == 0 )
+    return;
+
+  // Una fila por proceso y los totales del trabajo: el tiempo real va desde
+  // el lanzamiento del primero hasta la recogida del último.
+  writef ( fd, "\n%-16s %10s %10s %10s %10s %12s\n", "programa", "real", "user", "sys", "maxrss", "ctx vol/inv" );
+  inicio = trabajo->procesos[0].inicio;
+  fin = trabajo->procesos[0].fin;
+  for ( i = 0; i < trabajo->numProcesos; ++i )
+  {
+    ProcesoTrabajo* proceso = &(trabajo->procesos[i]);
+    char cambios [ 32 ];
+
+    snprintf ( cambios, sizeof(cambios), "%ld/%ld", proceso->uso.ru_nvcsw, proceso->uso.ru_nivcsw );
+    writef ( fd, "%-16s %9.3fs %9.3fs %9.3fs %8ldKB %12s\n", proceso->nombre,
+             segundos_timespec ( &(proceso->inicio), &(proceso->fin) ),
+             segundos_timeval ( &(proceso->uso.ru_utime) ),
+             segundos_timeval ( &(proceso->uso.ru_stime) ),
+             proceso->uso.ru_maxrss, cambios );
+
+    user += segundos_timeval ( &(proceso->uso.ru_utime) );
+    sys += segundos_timeval ( &(proceso->uso.ru_stime) );
+    if ( proceso->uso.ru_maxrss > maxrss )
+      maxrss = proceso->uso.ru_maxrss;
+    voluntarios += proceso->uso.ru_nvcsw;
+    involuntarios += proceso->uso.ru_nivcsw;
+    if ( segundos_timespec ( &fin, &(proceso->fin) ) > 0 )
+      fin = proceso->fin;
+  }
+
+  if ( trabajo->numProcesos > 1 )
+  {
+    char cambios [ 32 ];
+
+    snprintf ( cambios, sizeof(cambios), "%ld/%ld", voluntarios, involuntarios );
+    writef ( fd, "%-16s %9.3fs %9.3fs %9.3fs %8ldKB %12s\n", "total",
+             segundos_timespec ( &inicio, &fin ), user, sys, maxrss, cambios );
+  }
+}
+
+static void trabajos_mostrar_trabajo ( Trabajo* trabajo, int fd, int posicion )
+{
+  char marca = ' ';
+  const char* estado = "Ejecutando";
+  char salida [ 32 ];
+
+  if ( posicion == numTrabajos - 1 )
+    marca = '+';
+  else if ( posicion == numTrabajos - 2 )
+    marca = '-';
+
+  if ( trabajo_terminado ( trabajo ) )
+  {
+    int codigo = trabajos_codigo_salida ( trabajo->procesos [ trabajo->numProcesos - 1 ].estado );
+    if ( codigo == 0 )
+    {
+      estado = "Hecho";
+    }
+    else
+    {
+      snprintf ( salida, sizeof(salida), "Salida %d", codigo );
+      estado = salida;
+    }
+  }
+  else if ( trabajo_detenido ( trabajo ) )
+  {
+    estado = "Detenido";
+  }
+
+  writef ( fd, "[%d]%c  %-16s%s\n", trabajo->id, marca, estado, trabajo->comando );
+}
+
+static void trabajos_eliminar_terminados ()
+{
+  int i = 0;
+
+  while ( i < numTrabajos )
+  {
+    if ( trabajo_terminado ( trabajos[i] ) )
+    {
+      if ( trabajos[i]->medir )
+        trabajos_mostrar_tiempos ( trabajos[i], 2 );
+      trabajos_eliminar ( trabajos[i] );
+    }
+    else
+      ++i;
+  }
+}
+
+void trabajos_notificar ( int fd )
+{
+  int i;
+
+  trabajos_recoger ();
+
+  // Sin control de trabajos no avisamos de nada, como bash en los scripts.
+  for ( i = 0; control && ( i < numTrabajos ); ++i )
+  {
+    if ( trabajos[i]->notificar &&
+         ( trabajo_terminado ( trabajos[i] ) || trabajo_detenido ( trabajos[i] ) ) )
+      trabajos_mostrar_trabajo ( trabajos[i], fd, i );
+    trabajos[i]->notificar = 0;
+  }
+
+  trabajos_eliminar_terminados ();
+}
+
+void trabajos_mostrar ( int fd )
+{
+  int i;
+
+  trabajos_recoger ();
+
+  for ( i = 0; i < numTrabajos; ++i )
+  {
+    trabajos_mostrar_trabajo ( trabajos[i], fd, i );
+    trabajos[i]->notificar = 0;
+  }
+
+  trabajos_eliminar_terminados ();
+}
+
+// Devuelve el trabajo lanzado que ocupa la posición indicada contando desde
+// el final (0 es el actual). El trabajo que se está lanzando todavía no cuenta,
+// para que un %% en su propia línea se refiera al anterior.
+static Trabajo* trabajos_lanzado ( int posicion )
+{
+  int i;
+
+  for ( i = numTrabajos - 1; i >= 0; --i )
+  {
+    if ( trabajos[i]->lanzado && ( posicion-- == 0 ) )
+      return trabajos[i];
+  }
+
+  return NULL;
+}
+
+Trabajo* trabajos_buscar ( const char* especificacion )
+{
+  const char* p;
+  int id;
+  int i;
+
+  if ( ( especificacion == NULL ) || ( strcmp ( especificacion, "%%" ) == 0 ) ||
+       ( strcmp ( especificacion, "%+" ) == 0 ) )
+    return trabajos_lanzado ( 0 );
+
+  if ( strcmp ( especificacion, "%-" ) == 0 )
+    return trabajos_lanzado ( 1 );
+
+  // %n: el número tiene que ocupar el resto de la especificación.
+  if ( ( especificacion[0] != '%' ) || ( especificacion[1] == '\0' ) )
+    return NULL;
+  for ( p = &(especificacion[1]); *p != '\0'; ++p )
+  {
+    if ( ( *p < '0' ) || ( *p > '9' ) )
+      return NULL;
+  }
+
+  id = atoi ( &(especificacion[1]) );
+  for ( i = 0; i < numTrabajos; ++i )
+  {
+    if ( trabajos[i]->lanzado && ( trabajos[i]->id == id ) )
+      return trabajos[i];
+  }
+
+  return NULL;
+}
+
+const char* trabajos_comando ( Trabajo* trabajo )
+{
+  return trabajo->comando;
+}
+
+int trabajos_senyal ( Trabajo* trabajo, int senyal )
+{
+  int resultado = 0;
+  int i;
+
+  // Con control de trabajos la señal llega a todo el grupo; sin él, a cada
+  // proceso del trabajo que siga vivo.
+  if ( control )
+    return kill ( -trabajo->pgid, senyal );
+
+  for ( i = 0; i < trabajo->numProcesos; ++i )
+  {
+    if ( !trabajo->procesos[i].terminado && ( kill ( trabajo->procesos[i].pid, senyal ) == -1 ) )
+      resultado = -1;
+  }
+
+  return resultado;
+}
+
+pid_t trabajos_obtener_pid ( Trabajo* trabajo )
+{
+  if ( control )
+    return trabajo->pgid;
+  return ( trabajo->numProcesos > 0 ) ? trabajo->procesos[0].pid : -1;
+}
+
+int trabajos_senyales_ignoradas ( sigset_t* senyales )
+{
+  *senyales = senyalesIgnoradas;
+  return control;
+}
+
+void trabajos_restaurar_hijo ( pid_t grupo )
+{
+  int senyal;
+
+  if ( !control )
+    return;
+
+  if ( grupo != -1 )
+    setpgid ( 0, grupo );
+  for ( senyal = 1; senyal < NSIG; ++senyal )
+  {
+    if ( sigismember ( &senyalesIgnoradas, senyal ) == 1 )
+      signal ( senyal, SIG_DFL );
+  }
+}
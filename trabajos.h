@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       trabajos.h
+ * DESCRIPCIÓN:   Tabla de trabajos y control de trabajos (fg, bg, jobs).
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#pragma once
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+
+struct Trabajo_;
+typedef struct Trabajo_ Trabajo;
+
+// Con control de trabajos (sesiones interactivas), cada trabajo tiene su
+// propio grupo de procesos y el terminal se cede al que está en primer plano.
+void trabajos_inicializar ( int controlTrabajos );
+void trabajos_finalizar ();
+
+// Crea un trabajo vacío para la línea indicada.
+Trabajo* trabajos_crear ( const char* comando );
+void trabajos_eliminar ( Trabajo* trabajo );
+
+// Grupo en el que lanzar el siguiente proceso del trabajo: 0 para el primero,
+// el pgid del trabajo para el resto, o -1 si no hay control de trabajos.
+pid_t trabajos_grupo ( Trabajo* trabajo );
+void trabajos_anyadir_proceso ( Trabajo* trabajo, pid_t pid, const char* nombre );
+
+// Al terminar el trabajo, muestra por la salida de errores el tiempo real, el
+// de CPU, la memoria máxima y los cambios de contexto de cada proceso.
+void trabajos_medir ( Trabajo* trabajo );
+
+// Espera al trabajo en primer plano hasta que termine o se detenga, y devuelve
+// el código de salida de su último proceso. Si continuar es 1, se le envía SIGCONT.
+int trabajos_primer_plano ( Trabajo* trabajo, int continuar );
+void trabajos_segundo_plano ( Trabajo* trabajo, int continuar );
+
+// Recoge sin bloquear los procesos que hayan cambiado de estado.
+void trabajos_recoger ();
+
+// Anota el estado de un hijo recogido fuera de esta tabla en su trabajo, si
+// pertenece a alguno.
+void trabajos_registrar ( pid_t pid, int estado, const struct rusage* uso );
+
+// Avisa de los trabajos terminados o detenidos y elimina los terminados.
+void trabajos_notificar ( int fd );
+void trabajos_mostrar ( int fd );
+
+// Busca un trabajo por su especificación: %n, %%, %+ o %-. Sin
+// especificación, devuelve el trabajo actual.
+Trabajo* trabajos_buscar ( const char* especificacion );
+const char* trabajos_comando ( Trabajo* trabajo );
+pid_t trabajos_obtener_pid ( Trabajo* trabajo );
+
+// Envía una señal a todos los procesos del trabajo. Devuelve -1 si falla.
+int trabajos_senyal ( Trabajo* trabajo, int senyal );
+
+// Código de salida, al estilo de $?, de un estado devuelto por waitpid.
+int trabajos_codigo_salida ( int estado );
+
+// Señales que ignora el shell y que los hijos deben recibir con su acción por
+// defecto. Devuelve 0 si no hay ninguna.
+int trabajos_senyales_ignoradas ( sigset_t* senyales );
+
+// En un hijo creado con fork: entra en el grupo indicado (si no es -1) y
+// restaura las señales.
+void trabajos_restaurar_hijo ( pid_t grupo );
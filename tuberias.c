@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2009-2010 Alberto Alonso Pinto
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * FICHERO:       tuberias.c
+ * DESCRIPCIÓN:   Creación de pipes con capacidad configurable (F_SETPIPE_SZ).
+ * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
+ *
+ * CAMBIOS:
+ * - Código fuente inicial.
+ */
+
+#define _GNU_SOURCE             // pipe2, F_SETPIPE_SZ
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "io.h"
+#include "tuberias.h"
+
+static int tuberias_tamanyo = 0;
+static int tuberias_maximo = -1;
+
+// Estadísticas de los pipes creados.
+static struct
+{
+  int creados;
+  int ampliados;
+  int fallidos;
+  int ultimoConseguido;
+  int minimoConseguido;
+  int maximoConseguido;
+} estadisticas;
+
+static int tuberias_maximo_sistema ()
+{
+  // Sólo leemos el límite del sistema la primera vez.
+  if ( tuberias_maximo == -1 )
+  {
+    char buffer [ 32 ];
+    int fd = open ( "/proc/sys/fs/pipe-max-size", O_RDONLY | O_CLOEXEC );
+    int n = -1;
+
+    tuberias_maximo = 0;
+    if ( fd != -1 )
+    {
+      n = read ( fd, buffer, sizeof(buffer) - 1 );
+      close ( fd );
+    }
+    if ( n > 0 )
+    {
+      buffer[n] = '\0';
+      tuberias_maximo = atoi ( buffer );
+    }
+  }
+
+  return tuberias_maximo;
+}
+
+static void tuberias_anotar ( int conseguido )
+{
+  estadisticas.ultimoConseguido = conseguido;
+  if ( ( estadisticas.minimoConseguido == 0 ) || ( conseguido < estadisticas.minimoConseguido ) )
+    estadisticas.minimoConseguido = conseguido;
+  if ( conseguido > estadisticas.maximoConseguido )
+    estadisticas.maximoConseguido = conseguido;
+}
+
+int tuberias_crear ( int fds[2], int tamanyo )
+{
+  int maximo;
+  int conseguido;
+
+  if ( pipe2 ( fds, O_CLOEXEC ) == -1 )
+    return -1;
+  estadisticas.creados++;
+
+  if ( tamanyo <= 0 )
+    return 0;
+
+  // El núcleo redondea el tamaño a páginas y no deja pasar del máximo a los
+  // usuarios sin privilegios, así que lo limitamos nosotros.
+  maximo = tuberias_maximo_sistema ();
+  if ( ( maximo > 0 ) && ( tamanyo > maximo ) )
+    tamanyo = maximo;
+
+  // Si no se puede ampliar (por ejemplo, por el límite de memoria de pipes
+  // del usuario), el pipe sigue siendo válido con su tamaño por defecto.
+  conseguido = fcntl ( fds[1], F_SETPIPE_SZ, tamanyo );
+  if ( conseguido == -1 )
+  {
+    estadisticas.fallidos++;
+    conseguido = fcntl ( fds[1], F_GETPIPE_SZ );
+  }
+  else
+  {
+    estadisticas.ampliados++;
+  }
+
+  if ( conseguido > 0 )
+    tuberias_anotar ( conseguido );
+
+  return 0;
+}
+
+void tuberias_establecer_tamanyo ( int tamanyo )
+{
+  tuberias_tamanyo = tamanyo;
+}
+
+int tuberias_obtener_tamanyo ()
+{
+  return tuberias_tamanyo;
+}
+
+int tuberias_interpretar_tamanyo ( const char* texto )
+{
+  char* final;
+  long valor;
+
+  errno = 0;
+  valor = strtol ( texto, &final, 10 );
+  if ( ( errno != 0 ) || ( final == texto ) || ( valor < 0 ) )
+    return -1;
+
+  if ( ( *final == 'k' ) || ( *final == 'K' ) )
+  {
+    valor *= 1024;
+    ++final;
+  }
+  else if ( ( *final == 'm' ) || ( *final == 'M' ) )
+  {
+    valor *= 1024 * 1024;
+    ++final;
+  }
+
+  if ( ( *final != '\0' ) || ( valor > 0x7FFFFFFF ) )
+    return -1;
+
+  return (int)valor;
+}
+
+void tuberias_mostrar ( int fd )
+{
+  if ( tuberias_tamanyo > 0 )
+    writef ( fd, "tamaño solicitado:  %d bytes\n", tuberias_tamanyo );
+  else
+    writef ( fd, "tamaño solicitado:  por defecto\n" );
+  writef ( fd, "máximo del sistema: %d bytes\n", tuberias_maximo_sistema () );
+  writef ( fd, "pipes creados:      %d (%d ampliados, %d sin ampliar)\n",
+           estadisticas.creados, estadisticas.ampliados, estadisticas.fallidos );
+  if ( estadisticas.ultimoConseguido > 0 )
+  {
+    writef ( fd, "tamaño conseguido:  último %d, mínimo %d, máximo %d bytes\n",
+             estadisticas.ultimoConseguido, estadisticas.minimoConseguido,
+             estadisticas.maximoConseguido );
+  }
+}
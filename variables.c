@@ -27,25 +27,26 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       variables.c
- * DESCRIPCIN:   Variables.
+ * DESCRIPCIÓN:   Variables.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "arena.h"
+#include "cadena.h"
 #include "config.h"
-#include "infolinea.h"
 #include "variables.h"
 
 // Estructura para almacenar una variables.
 typedef struct
 {
-  char clave [ 256 ];
-  char valor [ 256 ];
+  char* clave;
+  char* valor;
 } Variable;
 
 // Nodos de la tabla hash.
@@ -63,11 +64,11 @@ struct Variables_
 
 static inline unsigned int variables_hash ( const char* str )
 {
-  // Intentaremos generar un hash con una buena dispersin
-  // y evitando el solapamiento al mximo. Un buen desplazamiento
+  // Intentaremos generar un hash con una buena dispersión
+  // y evitando el solapamiento al máximo. Un buen desplazamiento
   // para esto puede ser 7, requiriendo 32 vueltas antes de
-  // que los bits vuelvan a la posicin original al ser primo.
-  // Adems, como en cada vuelta se aaden 8 nuevos bits, el
+  // que los bits vuelvan a la posición original al ser primo.
+  // Además, como en cada vuelta se añaden 8 nuevos bits, el
   // solapamiento es de un solo bit.
   unsigned int result = 0;
   const char* p = str;
@@ -102,6 +103,8 @@ void variables_eliminar ( Variables* variables )
       for ( actual = variables->nodos[i]; actual != NULL; actual = siguiente )
       {
         siguiente = actual->siguiente;
+        free ( actual->variable.clave );
+        free ( actual->variable.valor );
         free ( actual );
       }
     }
@@ -133,6 +136,7 @@ void variables_establecer ( Variables* variables, const char* clave, const char*
 {
   // Buscamos el nodo, si existe, de esta variable.
   NodoHash* nodo = variables_buscar_nodo ( variables, clave );
+  char* copia;
 
   // Si no se ha encontrado, creamos uno nuevo.
   if ( nodo == NULL )
@@ -142,13 +146,15 @@ void variables_establecer ( Variables* variables, const char* clave, const char*
 
     nodo = (NodoHash *)malloc(sizeof(NodoHash));
     memset ( nodo, 0, sizeof(NodoHash) );
-    strcpy ( nodo->variable.clave, clave );
+    nodo->variable.clave = strdup ( clave );
     nodo->siguiente = variables->nodos [ pos ];
     variables->nodos [ pos ] = nodo;
   }
 
-  // Cambiamos el valor.
-  strcpy ( nodo->variable.valor, valor );
+  // Cambiamos el valor, copiándolo antes de liberar el anterior.
+  copia = strdup ( valor );
+  free ( nodo->variable.valor );
+  nodo->variable.valor = copia;
 }
 
 const char* variables_obtener ( Variables* variables, const char* clave )
@@ -168,125 +174,81 @@ const char* variables_obtener ( Variables* variables, const char* clave )
 
 
 
-char* variables_procesar_linea ( Variables* variables, char* linea, char* nuevaLinea )
+typedef struct
 {
-  char* p;
+  Variables* variables;
+  Arena* arena;
+} Expansion;
 
-  // Primero comprobamos si hay alguna variable.
-  char* primerEspacio = strchr ( linea, ' ' );
-  char* igualdad = strchr ( linea, '=' );
+static void expandir_parte ( PartePalabra* parte, void* contexto )
+{
+  Expansion* expansion = (Expansion *)contexto;
+  const char* valor = variables_obtener ( expansion->variables, parte->texto );
+  char* texto;
 
-  int hayAsignacion = ( igualdad != NULL ) && ( ( primerEspacio == NULL ) || ( igualdad < primerEspacio ) );
-  int hayVariables = hayAsignacion || ( strchr ( linea, '$' ) != NULL );
-  if ( !hayVariables )
+  // Las variables que no existen se dejan tal cual, con su $.
+  if ( valor != NULL )
   {
-    return linea;
+    texto = arena_strdup ( expansion->arena, valor );
+    parte->expandida = 1;
   }
-
-  // Comprobamos si estn intentando asignar un valor a una variable.
-  if ( igualdad != NULL )
+  else
   {
-    // Buscamos el primer espacio. Si la igualdad est antes que este, o no
-    // hay espacios, entonces es una asignacin.
-    p = strchr ( linea, ' ' );
-    if ( ( p == NULL ) || ( p > igualdad ) )
-    {
-      *igualdad = '\0';
-      ++igualdad;
+    texto = (char *)arena_reservar ( expansion->arena, strlen ( parte->texto ) + 2 );
+    sprintf ( texto, "$%s", parte->texto );
+  }
 
-      if ( p != NULL )
-      {
-        *p = '\0';
-        --p;
-      }
-      else
-      {
-        p = igualdad + strlen ( igualdad ) - 1;
-      }
+  parte->texto = texto;
+  parte->tipo = PARTE_LITERAL;
+}
 
-      // Si el valor est entrecomillado, eliminamos las comillas.
-      if ( ( ( igualdad[0] == '"' ) && ( *p == '"' ) ) ||
-           ( ( igualdad[0] == '\'' ) && ( *p == '\'' ) ) 
-         )
-      {
-        ++igualdad;
-        *p = '\0';
-      }
+void variables_expandir ( Variables* variables, Tuberia* tuberia, Arena* arena )
+{
+  Expansion expansion;
 
-      // Establecemos el valor de la variable.
-      variables_establecer ( variables, linea, igualdad );
+  expansion.variables = variables;
+  expansion.arena = arena;
+  analizador_recorrer_partes ( tuberia, PARTE_VARIABLE, expandir_parte, &expansion );
+}
 
-      // Retornamos una linea vaca.
-      nuevaLinea[0] = '\0';
-    }
-  }
+int variables_asignar ( Variables* variables, Tuberia* tuberia )
+{
+  Comando* comando = &(tuberia->comandos[0]);
+  PartePalabra* primera;
+  char* igualdad;
+  char* nombre;
+  Cadena valor;
+  int i;
 
-  else
-  {
-    nuevaLinea[0] = '\0';
+  // Es una asignación si la linea es una única palabra que empieza por
+  // NOMBRE=, escrito tal cual.
+  if ( ( tuberia->numComandos != 1 ) || ( comando->numPalabras != 1 ) || ( comando->numRedirecciones != 0 ) )
+    return 0;
 
-    // Procesamos la linea.
-    InfoLinea info;
-    infolinea_procesar ( &info, linea, NULL, -1 );
+  primera = &(comando->palabras[0].partes[0]);
+  if ( ( primera->tipo != PARTE_LITERAL ) || primera->entreComillas || primera->expandida )
+    return 0;
 
-    if ( info.numProgramas > 0 )
-    {
-      int i;
-      int j;
+  igualdad = strchr ( primera->texto, '=' );
+  if ( ( igualdad == NULL ) || ( igualdad == primera->texto ) )
+    return 0;
 
-      for ( i = 0; i < info.numProgramas; ++i )
-      {
-        for ( j = 0; j < info.programas[i].argc; ++j )
-        {
-          char* arg = info.programas[i].argv[j];
-          if ( arg[0] == '$' )
-          {
-            // Reemplazamos una variable por su valor.
-            const char* valor = variables_obtener ( variables, &(arg[1]) );
-            if ( valor != NULL )
-            {
-              strcat ( nuevaLinea, valor );
-              strcat ( nuevaLinea, " " );
-            }
-            else
-            {
-              strcat ( nuevaLinea, arg );
-              strcat ( nuevaLinea, " " );
-            }
-          }
-          else
-          {
-            strcat ( nuevaLinea, arg );
-            strcat ( nuevaLinea, " " );
-          }
-        }
-
-        if ( i < ( info.numProgramas - 1 ) )
-        {
-          strcat ( nuevaLinea, "| " );
-        }
-      }
+  // El valor es el resto de la palabra, ya expandido, sin partir.
+  cadena_inicializar ( &valor );
+  cadena_anyadir ( &valor, igualdad + 1 );
+  for ( i = 1; i < comando->palabras[0].numPartes; ++i )
+    cadena_anyadir ( &valor, comando->palabras[0].partes[i].texto );
 
-      if ( info.ficheroSalida[0] != '\0' )
-      {
-        if ( info.salidaAgregada )
-        {
-          strcat ( nuevaLinea, ">>" );
-        }
-        else
-        {
-          strcat ( nuevaLinea, ">" );
-        }
-        strcat ( nuevaLinea, info.ficheroSalida );
-        strcat ( nuevaLinea, " ");
-      }
-      if ( info.ejecutarEnSpawn )
-      {
-        strcat ( nuevaLinea, "& " );
-      }
-    }
-  }
+  nombre = strndup ( primera->texto, igualdad - primera->texto );
+  variables_establecer ( variables, nombre, valor.datos );
+
+  // Los programas se buscan en el PATH del entorno, y la caché de rutas se
+  // invalida al cambiar éste: lo exportamos para que la asignación surta efecto.
+  if ( ( strcmp ( nombre, "PATH" ) == 0 ) && ( setenv ( nombre, valor.datos, 1 ) != 0 ) )
+    perror ( "setenv" );
+  free ( nombre );
+  cadena_liberar ( &valor );
 
-  return nuevaLinea;
+  return 1;
 }
 
@@ -27,15 +27,17 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       variables.h
- * DESCRIPCIN:   Variables.
+ * DESCRIPCIÓN:   Variables.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #pragma once
 
+#include "analizador.h"
+
 struct Variables_;
 typedef struct Variables_ Variables;
 
@@ -43,4 +45,9 @@ Variables* variables_crear ();
 void variables_eliminar ( Variables* variables );
 void variables_establecer ( Variables* variables, const char* clave, const char* valor );
 const char* variables_obtener ( Variables* variables, const char* clave );
-char* variables_procesar_linea ( Variables* variables, char* linea, char* nuevaLinea );
+
+// Sustituye las variables de la pipeline por su valor.
+void variables_expandir ( Variables* variables, Tuberia* tuberia, Arena* arena );
+
+// Si la pipeline es una asignación VAR=valor, la realiza y devuelve 1.
+int variables_asignar ( Variables* variables, Tuberia* tuberia );
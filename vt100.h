@@ -27,11 +27,11 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  * FICHERO:       vt100.h
- * DESCRIPCIN:   Declaracin de las secuencias de escape concretas de VT100.
+ * DESCRIPCIÓN:   Declaración de las secuencias de escape concretas de VT100.
  * AUTORES:       Alberto Alonso Pinto <rydencillo@gmail.com>
  *
  * CAMBIOS:
- * - (2009-2010) Cdigo fuente inicial.
+ * - (2009-2010) Código fuente inicial.
  */
 
 #pragma once
@@ -41,23 +41,50 @@
 static const TerminalSecuenciasEscape* obtenerSecuenciasEscapeVT100 ()
 {
   static TerminalSecuenciasEscape vt100 = {
-    .maxBytes = 4,
-    .numSecuencias = 13,
+    .maxBytes = 8,
+    .numSecuencias = 34,
     .secuencias = {
+      // Teclas. Los terminales envían unas u otras según el modo del teclado
+      // y la emulación, así que aceptamos todas las variantes habituales.
        { FLECHA_ARRIBA,     "\033[A"  }
+      ,{ FLECHA_ARRIBA,     "\033OA"  }
       ,{ FLECHA_ABAJO,      "\033[B"  }
+      ,{ FLECHA_ABAJO,      "\033OB"  }
       ,{ FLECHA_IZQUIERDA,  "\033[D"  }
+      ,{ FLECHA_IZQUIERDA,  "\033OD"  }
       ,{ FLECHA_DERECHA,    "\033[C"  }
+      ,{ FLECHA_DERECHA,    "\033OC"  }
       ,{ IR_INICIO,         "\033[1~" }
+      ,{ IR_INICIO,         "\033[7~" }
+      ,{ IR_INICIO,         "\033[H"  }
+      ,{ IR_INICIO,         "\033OH"  }
       ,{ IR_FINAL,          "\033[4~" }
+      ,{ IR_FINAL,          "\033[8~" }
+      ,{ IR_FINAL,          "\033[F"  }
+      ,{ IR_FINAL,          "\033OF"  }
       ,{ PAGINA_ARRIBA,     "\033[5~" }
       ,{ PAGINA_ABAJO,      "\033[6~" }
+      ,{ LINEA_SUPRIMIR,    "\033[3~" }
+      ,{ PEGADO_INICIO,     "\033[200~" }
+      ,{ PEGADO_FIN,        "\033[201~" }
+
+      // Secuencias de salida.
+      ,{ CURSOR_IZQUIERDA,  "\b" }
+      ,{ CURSOR_DERECHA,    "\033[C" }
+      ,{ CURSOR_IZQUIERDA_N, "\033[%p1%dD" }
+      ,{ CURSOR_DERECHA_N,  "\033[%p1%dC" }
+      ,{ PANTALLA_LIMPIAR,  "\033[2J\033[H" }
 
       ,{ LINEA_LIMPIAR_DERECHA,   "\033[K"  }
-      ,{ LINEA_LIMPIAR_DERECHA,   "\033[0K" }
       ,{ LINEA_LIMPIAR_IZQUIERDA, "\033[1K" }
       ,{ LINEA_LIMPIAR_ENTERA,    "\033[2K" }
-      ,{ LINEA_SUPRIMIR,          "\033[3~" }
+
+      ,{ PEGADO_ACTIVAR,          "\033[?2004h" }
+      ,{ PEGADO_DESACTIVAR,       "\033[?2004l" }
+
+      ,{ ATRIBUTOS_NORMALES,      "\033[0m" }
+      ,{ ATRIBUTO_NEGRITA,        "\033[1m" }
+      ,{ COLOR_TEXTO,             "\033[3%p1%dm" }
     }
   };
 